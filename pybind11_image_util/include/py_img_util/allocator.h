@@ -0,0 +1,175 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace detail
+	{
+		/// Size and alignment of a transparent huge page on x86-64 and most aarch64 configurations
+		inline constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+		inline std::atomic<size_t>& huge_page_threshold_storage()
+		{
+			static std::atomic<size_t> threshold = 32 * 1024 * 1024;
+			return threshold;
+		}
+	} // detail
+
+
+	/// The buffer size in bytes from which on huge_page_allocator maps huge pages. Defaults to 32 MiB.
+	inline size_t huge_page_threshold() noexcept
+	{
+		return detail::huge_page_threshold_storage().load(std::memory_order_relaxed);
+	}
+
+	/// Set the buffer size in bytes from which on huge_page_allocator maps huge pages, pass
+	/// std::numeric_limits<size_t>::max() to disable huge pages entirely. Only affects allocators constructed
+	/// after the call.
+	inline void set_huge_page_threshold(size_t bytes) noexcept
+	{
+		detail::huge_page_threshold_storage().store(bytes, std::memory_order_relaxed);
+	}
+
+
+	/// Allocator backing large buffers with transparent huge pages to cut down the number of page faults on first
+	/// touch (a 1 GiB buffer takes 512 faults instead of 262144).
+	///
+	/// On Linux allocations of at least huge_page_threshold() bytes are mapped with a 2 MiB aligned anonymous mmap
+	/// and advised with MADV_HUGEPAGE. If THP is unavailable or disabled the advice is ignored and the mapping
+	/// simply uses regular pages. Smaller allocations and other platforms use the global operator new.
+	///
+	/// Elements are default-initialized rather than value-initialized, i.e. `huge_vector<float>(n)` does not
+	/// write zeros. This leaves the first touch of each page to whoever fills the buffer, for the conversions in
+	/// this library that is the threads of the parallel copy so faults are spread across cores.
+	///
+	/// \tparam T The element type
+	template <typename T>
+	class huge_page_allocator
+	{
+	public:
+		using value_type = T;
+
+		template <typename U>
+		friend class huge_page_allocator;
+
+		huge_page_allocator() noexcept : m_Threshold(huge_page_threshold()) {}
+
+		template <typename U>
+		huge_page_allocator(const huge_page_allocator<U>& other) noexcept : m_Threshold(other.m_Threshold) {}
+
+		T* allocate(size_t n)
+		{
+			if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+			{
+				throw std::bad_array_new_length();
+			}
+			const size_t bytes = n * sizeof(T);
+			if (!uses_huge_pages(bytes))
+			{
+				return static_cast<T*>(::operator new(bytes, std::align_val_t{ alignof(T) }));
+			}
+#if defined(__linux__)
+			// Over-allocate by one huge page so we can trim the mapping down to a 2 MiB aligned region
+			const size_t mapped_bytes = round_up(bytes) + detail::huge_page_size;
+			void* mapping = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (mapping == MAP_FAILED)
+			{
+				throw std::bad_alloc();
+			}
+			const auto address = reinterpret_cast<uintptr_t>(mapping);
+			const uintptr_t aligned = (address + detail::huge_page_size - 1) & ~(uintptr_t{ detail::huge_page_size } - 1);
+			const size_t head = aligned - address;
+			const size_t tail = mapped_bytes - head - round_up(bytes);
+			if (head != 0)
+			{
+				::munmap(mapping, head);
+			}
+			if (tail != 0)
+			{
+				::munmap(reinterpret_cast<void*>(aligned + round_up(bytes)), tail);
+			}
+#if defined(MADV_HUGEPAGE)
+			// Failure here only means THP is unavailable, the mapping remains valid with regular pages
+			::madvise(reinterpret_cast<void*>(aligned), round_up(bytes), MADV_HUGEPAGE);
+#endif
+			return reinterpret_cast<T*>(aligned);
+#else
+			return static_cast<T*>(::operator new(bytes, std::align_val_t{ alignof(T) }));
+#endif
+		}
+
+		void deallocate(T* ptr, size_t n) noexcept
+		{
+			const size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+			if (uses_huge_pages(bytes))
+			{
+				::munmap(ptr, round_up(bytes));
+				return;
+			}
+#endif
+			::operator delete(ptr, std::align_val_t{ alignof(T) });
+		}
+
+		/// Default-initialize rather than value-initialize elements so that resizing does not touch the pages
+		template <typename U>
+		void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+		{
+			::new (static_cast<void*>(ptr)) U;
+		}
+
+		template <typename U, typename... Args>
+		void construct(U* ptr, Args&&... args)
+		{
+			::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+		}
+
+		/// Whether an allocation of the given size is backed by huge pages
+		bool uses_huge_pages(size_t bytes) const noexcept
+		{
+			return bytes >= m_Threshold && bytes > 0;
+		}
+
+		template <typename U>
+		bool operator==(const huge_page_allocator<U>& other) const noexcept { return m_Threshold == other.m_Threshold; }
+
+	private:
+		/// The threshold is captured on construction so allocate() and deallocate() always agree on the path taken
+		size_t m_Threshold = 0;
+
+		static size_t round_up(size_t bytes) noexcept
+		{
+			return (bytes + detail::huge_page_size - 1) / detail::huge_page_size * detail::huge_page_size;
+		}
+	};
+
+
+	/// A std::vector whose large buffers are backed by transparent huge pages, see huge_page_allocator.
+	///
+	/// \warning Unlike std::vector, `huge_vector<T>(n)` and `resize(n)` leave arithmetic elements uninitialized
+	/// (regardless of the size of the buffer) so that the filling thread touches each page first. Pass an 
+	/// explicit value, e.g. `huge_vector<float>(n, 0.0f)`, if the buffer has to be zeroed.
+	template <typename T>
+	using huge_vector = std::vector<T, huge_page_allocator<T>>;
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
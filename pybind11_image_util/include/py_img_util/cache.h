@@ -0,0 +1,391 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <list>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <cstring>
+#include <cstdint>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "macros.h"
+#include "validation.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	namespace detail
+	{
+
+		/// Mix a single 64-bit word into the running hash.
+		inline uint64_t hash_mix(uint64_t hash, uint64_t word)
+		{
+			hash ^= word + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+			return hash * 0xff51afd7ed558ccdull;
+		}
+
+		/// Hash a contiguous block of memory. This is not a cryptographic hash, it is only meant to detect
+		/// whether the contents of a cached array changed in-place.
+		inline uint64_t hash_bytes(const std::byte* data, size_t size)
+		{
+			uint64_t hash = 0xcbf29ce484222325ull ^ size;
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+			{
+				uint64_t word = 0;
+				std::memcpy(&word, data + i, sizeof(uint64_t));
+				hash = hash_mix(hash, word);
+			}
+			if (i < size)
+			{
+				uint64_t word = 0;
+				std::memcpy(&word, data + i, size - i);
+				hash = hash_mix(hash, word);
+			}
+			return hash;
+		}
+
+		/// Copy `size` bytes from `src` to `dst` while hashing the data. Equivalent to a memcpy followed by
+		/// hash_bytes(dst, size) but only streams through the data once.
+		inline uint64_t copy_and_hash(std::byte* dst, const std::byte* src, size_t size)
+		{
+			// Work in blocks small enough to stay in L1 so the hash reads the freshly written data from cache
+			constexpr size_t block_size = 16 * 1024;
+			uint64_t hash = 0xcbf29ce484222325ull ^ size;
+			size_t offset = 0;
+			while (offset < size)
+			{
+				size_t block = std::min(block_size, size - offset);
+				std::memcpy(dst + offset, src + offset, block);
+
+				size_t i = offset;
+				const size_t block_end = offset + block;
+				for (; i + sizeof(uint64_t) <= block_end; i += sizeof(uint64_t))
+				{
+					uint64_t word = 0;
+					std::memcpy(&word, dst + i, sizeof(uint64_t));
+					hash = hash_mix(hash, word);
+				}
+				if (i < block_end)
+				{
+					// Only the very last block may end on a partial word as all blocks are a multiple of 8 bytes
+					uint64_t word = 0;
+					std::memcpy(&word, dst + i, block_end - i);
+					hash = hash_mix(hash, word);
+				}
+				offset = block_end;
+			}
+			return hash;
+		}
+
+		/// Identity of a numpy array as seen by the conversion cache. Two arrays compare equal if they point
+		/// to the same memory with the same element type, shape and strides.
+		struct cache_key
+		{
+			uintptr_t data = 0;
+			std::type_index dtype = typeid(void);
+			std::vector<py::ssize_t> shape;
+			std::vector<py::ssize_t> strides;
+
+			template <typename T>
+			static cache_key from_array(const py::array_t<T>& array)
+			{
+				cache_key key;
+				key.data = reinterpret_cast<uintptr_t>(array.data());
+				key.dtype = typeid(T);
+				for (py::ssize_t i = 0; i < array.ndim(); ++i)
+				{
+					key.shape.push_back(array.shape(i));
+					key.strides.push_back(array.strides(i));
+				}
+				return key;
+			}
+
+			bool operator==(const cache_key& other) const = default;
+		};
+
+		struct cache_key_hash
+		{
+			size_t operator()(const cache_key& key) const
+			{
+				uint64_t hash = hash_mix(static_cast<uint64_t>(key.data), static_cast<uint64_t>(key.dtype.hash_code()));
+				for (const auto dim : key.shape)
+				{
+					hash = hash_mix(hash, static_cast<uint64_t>(dim));
+				}
+				for (const auto stride : key.strides)
+				{
+					hash = hash_mix(hash, static_cast<uint64_t>(stride));
+				}
+				return static_cast<size_t>(hash);
+			}
+		};
+
+	} // detail
+
+
+	/// Options for a conversion_cache
+	struct cache_options
+	{
+		/// The maximum number of bytes the cache may hold on to. Once exceeded the least recently used
+		/// entries are evicted. Arrays larger than this are converted but never cached.
+		size_t byte_budget = size_t{ 512 } * 1024 * 1024;
+
+		/// Whether to hash the contents during the copy and re-hash the source on every cache hit. This detects
+		/// arrays that were modified in-place on the python side at the cost of one read over the source data.
+		/// If disabled, callers must guarantee that cached arrays are not modified while they are alive.
+		bool verify_content = false;
+	};
+
+
+	/// Opt-in cache for repeated numpy -> C++ conversions of the same array.
+	///
+	/// Entries are keyed on the arrays' data pointer, element type, shape and strides and hold shared,
+	/// immutable buffers. An entry is dropped once the python array it was created from is garbage collected
+	/// (via a weak reference), when it gets evicted by the LRU byte budget or on clear().
+	///
+	/// \note The cache holds on to python objects and must therefore be created, used and destroyed
+	/// while holding the GIL.
+	class conversion_cache
+	{
+	public:
+
+		explicit conversion_cache(cache_options options = {})
+			: m_State(std::make_shared<state>())
+		{
+			m_State->options = options;
+		}
+
+		conversion_cache(const conversion_cache&) = delete;
+		conversion_cache& operator=(const conversion_cache&) = delete;
+
+		~conversion_cache()
+		{
+			clear();
+		}
+
+		/// Retrieve the converted buffer for `data` from the cache, or convert and insert it if it is not
+		/// present yet. The shape is validated on every call, identical to from_py_array(tag::vector{}, ...).
+		///
+		/// \param data The python array to convert, the callers' array is never modified.
+		/// \param expected_width The expected width (number of columns)
+		/// \param expected_height The expected height (number of rows)
+		/// \return A shared buffer holding the data in row-major order
+		template <typename T>
+		std::shared_ptr<const std::vector<T>> get_or_convert(const py::array_t<T>& data, size_t expected_width, size_t expected_height)
+		{
+			size_t expected_size = expected_height * expected_width;
+			auto shape = detail::shape_from_py_array(data, { 1, 2 }, expected_size);
+			detail::check_shape(shape, expected_width, expected_height);
+
+			auto key = detail::cache_key::from_array(data);
+			if (auto cached = find<T>(key, data))
+			{
+				return cached;
+			}
+
+			// Convert on a local handle so the key of the callers' array stays stable across calls
+			py::array_t<T> source = data;
+			detail::check_c_style_contiguous(source);
+			detail::check_not_null(source);
+
+			auto buffer = std::make_shared<std::vector<T>>(expected_size);
+			uint64_t hash = 0;
+			const size_t byte_size = expected_size * sizeof(T);
+			if (m_State->options.verify_content)
+			{
+				hash = detail::copy_and_hash(
+					reinterpret_cast<std::byte*>(buffer->data()),
+					reinterpret_cast<const std::byte*>(source.data()),
+					byte_size
+				);
+			}
+			else
+			{
+				std::memcpy(buffer->data(), source.data(), byte_size);
+			}
+
+			insert<T>(std::move(key), data, buffer, byte_size, hash);
+			return buffer;
+		}
+
+		/// Drop all entries from the cache
+		void clear()
+		{
+			std::unordered_map<detail::cache_key, entry, detail::cache_key_hash> evicted;
+			{
+				std::lock_guard<std::mutex> lock(m_State->mutex);
+				evicted.swap(m_State->entries);
+				m_State->lru.clear();
+				m_State->bytes = 0;
+			}
+			// evicted goes out of scope here, outside of the lock, releasing the weak references
+		}
+
+		/// The number of entries currently held
+		size_t size() const
+		{
+			std::lock_guard<std::mutex> lock(m_State->mutex);
+			return m_State->entries.size();
+		}
+
+		/// The number of bytes currently held
+		size_t bytes() const
+		{
+			std::lock_guard<std::mutex> lock(m_State->mutex);
+			return m_State->bytes;
+		}
+
+		/// The number of lookups served from the cache
+		size_t hits() const
+		{
+			std::lock_guard<std::mutex> lock(m_State->mutex);
+			return m_State->hits;
+		}
+
+		/// The number of lookups that required a conversion
+		size_t misses() const
+		{
+			std::lock_guard<std::mutex> lock(m_State->mutex);
+			return m_State->misses;
+		}
+
+	private:
+
+		struct entry
+		{
+			std::shared_ptr<const void> buffer;
+			size_t bytes = 0;
+			uint64_t hash = 0;
+			/// Weak reference to the source array, its callback removes this entry
+			py::object weakref;
+			std::list<detail::cache_key>::iterator lru_it;
+		};
+
+		/// Shared with the weak reference callbacks so these can safely outlive the cache itself
+		struct state
+		{
+			cache_options options;
+			mutable std::mutex mutex;
+			std::unordered_map<detail::cache_key, entry, detail::cache_key_hash> entries;
+			/// Most recently used keys at the front
+			std::list<detail::cache_key> lru;
+			size_t bytes = 0;
+			size_t hits = 0;
+			size_t misses = 0;
+		};
+
+		std::shared_ptr<state> m_State;
+
+
+		/// Look up the key, returning a nullptr on a miss or if the content verification failed
+		template <typename T>
+		std::shared_ptr<const std::vector<T>> find(const detail::cache_key& key, const py::array_t<T>& data)
+		{
+			std::shared_ptr<const void> buffer;
+			uint64_t hash = 0;
+			{
+				std::lock_guard<std::mutex> lock(m_State->mutex);
+				auto it = m_State->entries.find(key);
+				if (it == m_State->entries.end())
+				{
+					++m_State->misses;
+					return nullptr;
+				}
+				m_State->lru.splice(m_State->lru.begin(), m_State->lru, it->second.lru_it);
+				buffer = it->second.buffer;
+				hash = it->second.hash;
+			}
+
+			if (m_State->options.verify_content)
+			{
+				py::array_t<T> source = data;
+				detail::check_c_style_contiguous(source);
+				detail::check_not_null(source);
+				auto current_hash = detail::hash_bytes(reinterpret_cast<const std::byte*>(source.data()), source.size() * sizeof(T));
+				if (current_hash != hash)
+				{
+					std::lock_guard<std::mutex> lock(m_State->mutex);
+					++m_State->misses;
+					return nullptr;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(m_State->mutex);
+			++m_State->hits;
+			return std::static_pointer_cast<const std::vector<T>>(buffer);
+		}
+
+		template <typename T>
+		void insert(detail::cache_key key, const py::array_t<T>& data, std::shared_ptr<const std::vector<T>> buffer, size_t byte_size, uint64_t hash)
+		{
+			if (byte_size > m_State->options.byte_budget)
+			{
+				return;
+			}
+
+			// Create the weak reference before taking the lock, once the source array dies the callback
+			// removes the entry again. The callback only holds a weak_ptr to the state so it is safe to
+			// outlive the cache.
+			std::weak_ptr<state> weak_state = m_State;
+			py::object weakref = py::weakref(data, py::cpp_function([weak_state, key](py::handle)
+				{
+					if (auto state_ptr = weak_state.lock())
+					{
+						std::vector<entry> evicted;
+						{
+							std::lock_guard<std::mutex> lock(state_ptr->mutex);
+							conversion_cache::erase(*state_ptr, key, evicted);
+						}
+					}
+				}));
+
+			std::vector<entry> evicted;
+			{
+				std::lock_guard<std::mutex> lock(m_State->mutex);
+				conversion_cache::erase(*m_State, key, evicted);
+
+				while (!m_State->lru.empty() && m_State->bytes + byte_size > m_State->options.byte_budget)
+				{
+					// Copy the key as erase() invalidates the list node it lives in
+					auto lru_key = m_State->lru.back();
+					conversion_cache::erase(*m_State, lru_key, evicted);
+				}
+
+				m_State->lru.push_front(key);
+				entry new_entry{ std::move(buffer), byte_size, hash, std::move(weakref), m_State->lru.begin() };
+				m_State->entries.emplace(std::move(key), std::move(new_entry));
+				m_State->bytes += byte_size;
+			}
+			// evicted goes out of scope here, outside of the lock, releasing the weak references
+		}
+
+		/// Remove the entry for `key` if it exists, moving it into `evicted` so it can be destroyed after the
+		/// lock is released. Must be called with the lock held.
+		static void erase(state& state, const detail::cache_key& key, std::vector<entry>& evicted)
+		{
+			auto it = state.entries.find(key);
+			if (it == state.entries.end())
+			{
+				return;
+			}
+			state.bytes -= it->second.bytes;
+			state.lru.erase(it->second.lru_it);
+			evicted.push_back(std::move(it->second));
+			state.entries.erase(it);
+		}
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
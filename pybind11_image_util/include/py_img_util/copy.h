@@ -0,0 +1,251 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PY_IMG_UTIL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC allows the use of any intrinsic without enabling the instruction set, GCC and Clang require the function to
+// be compiled for the target explicitly
+#if defined(PY_IMG_UTIL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PY_IMG_UTIL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PY_IMG_UTIL_TARGET(isa)
+#endif
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace detail
+	{
+		inline std::atomic<size_t>& streaming_copy_threshold_storage()
+		{
+			static std::atomic<size_t> threshold = 64 * 1024 * 1024;
+			return threshold;
+		}
+	} // detail
+
+
+	/// The copy size in bytes from which on large copies bypass the cache using non-temporal stores. Defaults to
+	/// 64 MiB, i.e. buffers well beyond the size of a typical last level cache that would otherwise evict it entirely.
+	inline size_t streaming_copy_threshold() noexcept
+	{
+		return detail::streaming_copy_threshold_storage().load(std::memory_order_relaxed);
+	}
+
+	/// Set the copy size in bytes from which on copies use non-temporal stores. Pass 0 to stream every copy or
+	/// std::numeric_limits<size_t>::max() to always copy through the cache.
+	inline void set_streaming_copy_threshold(size_t bytes) noexcept
+	{
+		detail::streaming_copy_threshold_storage().store(bytes, std::memory_order_relaxed);
+	}
+
+
+	namespace detail
+	{
+
+		/// The instruction set used by stream_copy
+		enum class copy_isa
+		{
+			/// No non-temporal stores available, stream_copy falls back to memcpy
+			none,
+			sse2,
+			avx2,
+			avx512
+		};
+
+		/// How far ahead of the current position the source is prefetched, a few kilobytes cover the memory latency
+		/// at typical copy bandwidths
+		inline constexpr size_t streaming_prefetch_distance = 2048;
+
+		/// Query the widest instruction set usable for streaming copies on this CPU
+		inline copy_isa detect_copy_isa() noexcept
+		{
+#if defined(PY_IMG_UTIL_X86) && (defined(__GNUC__) || defined(__clang__))
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+			{
+				return copy_isa::avx512;
+			}
+			if (__builtin_cpu_supports("avx2"))
+			{
+				return copy_isa::avx2;
+			}
+			return copy_isa::sse2;
+#elif defined(PY_IMG_UTIL_X86) && defined(_MSC_VER)
+			int regs[4] = {};
+			__cpuid(regs, 1);
+			const bool osxsave = (regs[2] & (1 << 27)) != 0;
+			const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+			__cpuidex(regs, 7, 0);
+			// The OS has to save the ymm (and zmm) registers on context switches for the wider kernels to be usable
+			if ((regs[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6)
+			{
+				return copy_isa::avx512;
+			}
+			if ((regs[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6)
+			{
+				return copy_isa::avx2;
+			}
+			return copy_isa::sse2;
+#else
+			return copy_isa::none;
+#endif
+		}
+
+		/// The instruction set used for streaming copies, detected once on first use
+		inline copy_isa streaming_copy_isa() noexcept
+		{
+			static const copy_isa isa = detect_copy_isa();
+			return isa;
+		}
+
+#if defined(PY_IMG_UTIL_X86)
+		/// Copy the unaligned head with memcpy so the streaming stores hit `Alignment` aligned addresses, returns
+		/// the number of bytes copied.
+		template <size_t Alignment>
+		size_t stream_copy_head(std::byte* dst, const std::byte* src, size_t bytes) noexcept
+		{
+			const size_t misalignment = reinterpret_cast<uintptr_t>(dst) % Alignment;
+			const size_t head = std::min(bytes, misalignment == 0 ? 0 : Alignment - misalignment);
+			std::memcpy(dst, src, head);
+			return head;
+		}
+
+		PY_IMG_UTIL_TARGET("sse2")
+		inline void stream_copy_sse2(std::byte* dst, const std::byte* src, size_t bytes) noexcept
+		{
+			size_t offset = stream_copy_head<16>(dst, src, bytes);
+			for (; offset + 64 <= bytes; offset += 64)
+			{
+				_mm_prefetch(reinterpret_cast<const char*>(src + offset + streaming_prefetch_distance), _MM_HINT_NTA);
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset + 16));
+				const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset + 32));
+				const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset + 48));
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dst + offset), a);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dst + offset + 16), b);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dst + offset + 32), c);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dst + offset + 48), d);
+			}
+			// Non-temporal stores are weakly ordered, fence them before anyone else may read the destination
+			_mm_sfence();
+			std::memcpy(dst + offset, src + offset, bytes - offset);
+		}
+
+		PY_IMG_UTIL_TARGET("avx2")
+		inline void stream_copy_avx2(std::byte* dst, const std::byte* src, size_t bytes) noexcept
+		{
+			size_t offset = stream_copy_head<32>(dst, src, bytes);
+			for (; offset + 128 <= bytes; offset += 128)
+			{
+				_mm_prefetch(reinterpret_cast<const char*>(src + offset + streaming_prefetch_distance), _MM_HINT_NTA);
+				_mm_prefetch(reinterpret_cast<const char*>(src + offset + streaming_prefetch_distance + 64), _MM_HINT_NTA);
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + offset));
+				const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + offset + 32));
+				const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + offset + 64));
+				const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + offset + 96));
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + offset), a);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + offset + 32), b);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + offset + 64), c);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + offset + 96), d);
+			}
+			_mm_sfence();
+			std::memcpy(dst + offset, src + offset, bytes - offset);
+		}
+
+		PY_IMG_UTIL_TARGET("avx512f")
+		inline void stream_copy_avx512(std::byte* dst, const std::byte* src, size_t bytes) noexcept
+		{
+			size_t offset = stream_copy_head<64>(dst, src, bytes);
+			for (; offset + 256 <= bytes; offset += 256)
+			{
+				for (size_t line = 0; line < 256; line += 64)
+				{
+					_mm_prefetch(reinterpret_cast<const char*>(src + offset + streaming_prefetch_distance + line), _MM_HINT_NTA);
+				}
+				const __m512i a = _mm512_loadu_si512(reinterpret_cast<const __m512i*>(src + offset));
+				const __m512i b = _mm512_loadu_si512(reinterpret_cast<const __m512i*>(src + offset + 64));
+				const __m512i c = _mm512_loadu_si512(reinterpret_cast<const __m512i*>(src + offset + 128));
+				const __m512i d = _mm512_loadu_si512(reinterpret_cast<const __m512i*>(src + offset + 192));
+				_mm512_stream_si512(reinterpret_cast<__m512i*>(dst + offset), a);
+				_mm512_stream_si512(reinterpret_cast<__m512i*>(dst + offset + 64), b);
+				_mm512_stream_si512(reinterpret_cast<__m512i*>(dst + offset + 128), c);
+				_mm512_stream_si512(reinterpret_cast<__m512i*>(dst + offset + 192), d);
+			}
+			_mm_sfence();
+			std::memcpy(dst + offset, src + offset, bytes - offset);
+		}
+#endif
+
+		/// Copy `bytes` bytes from src to dst using non-temporal stores which bypass the cache, leaving its contents
+		/// intact for other threads. Uses the widest instruction set supported by the CPU and falls back to memcpy
+		/// on platforms without non-temporal store support. The buffers must not overlap.
+		inline void stream_copy(void* dst, const void* src, size_t bytes) noexcept
+		{
+#if defined(PY_IMG_UTIL_X86)
+			auto dst_bytes = static_cast<std::byte*>(dst);
+			auto src_bytes = static_cast<const std::byte*>(src);
+			switch (streaming_copy_isa())
+			{
+			case copy_isa::avx512:
+				stream_copy_avx512(dst_bytes, src_bytes, bytes);
+				return;
+			case copy_isa::avx2:
+				stream_copy_avx2(dst_bytes, src_bytes, bytes);
+				return;
+			case copy_isa::sse2:
+				stream_copy_sse2(dst_bytes, src_bytes, bytes);
+				return;
+			case copy_isa::none:
+				break;
+			}
+#endif
+			std::memcpy(dst, src, bytes);
+		}
+
+		/// Copy `count` elements from src to dst choosing between memcpy and stream_copy, `total_bytes` is the size
+		/// of the whole copy this is part of (e.g. when split into chunks) and is compared against
+		/// streaming_copy_threshold().
+		template <typename T>
+		void copy_elements(const T* src, T* dst, size_t count, size_t total_bytes) noexcept
+		{
+			if (total_bytes >= streaming_copy_threshold())
+			{
+				detail::stream_copy(dst, src, count * sizeof(T));
+			}
+			else
+			{
+				std::memcpy(dst, src, count * sizeof(T));
+			}
+		}
+
+		/// Copy `count` elements from src to dst choosing between memcpy and stream_copy based on the size of the copy
+		template <typename T>
+		void copy_elements(const T* src, T* dst, size_t count) noexcept
+		{
+			detail::copy_elements(src, dst, count, count * sizeof(T));
+		}
+
+	} // detail
+
+} // NAMESPACE_PY_IMAGE_UTIL
+
+#undef PY_IMG_UTIL_TARGET
+#undef PY_IMG_UTIL_X86
\ No newline at end of file
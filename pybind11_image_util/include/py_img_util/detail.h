@@ -9,12 +9,34 @@
 #include <unordered_map>
 #include <string>
 #include <span>
+#include <memory>
+#include <array>
+#include <cassert>
+#include <atomic>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <functional>
 
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 #include "macros.h"
+#include "policy.h"
 #include "validation.h"
+#include "typed_image.h"
+#include "planar_view.h"
+#include "sparse_image.h"
+#include "packed.h"
+#include "encoding.h"
+#include "quantize.h"
+#include "mip.h"
+#include "parallel.h"
+#include "copy.h"
+#include "memory.h"
+#include "allocator.h"
+#include "trace.h"
 
 
 namespace NAMESPACE_PY_IMAGE_UTIL
@@ -25,25 +47,223 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	namespace detail
 	{
 
+		/// Transpose the row-major `rows` x `cols` matrix `src` into the row-major `cols` x `rows` matrix `dst`.
+		/// 
+		/// The transpose is done in square tiles small enough for a source and destination tile to stay in L1 
+		/// so that neither the strided reads nor the writes thrash the cache on large images, the contiguous
+		/// writes within a tile are left to the compilers' vectorizer. Bands of output rows are processed in 
+		/// parallel, this does not call into python and may be called with the GIL released.
+		template <typename T>
+		void transpose_blocked(const T* src, T* dst, size_t rows, size_t cols)
+		{
+			constexpr size_t block = sizeof(T) >= 8 ? 16 : 32;
+			const size_t num_col_blocks = (cols + block - 1) / block;
+			const size_t grain = detail::parallel_grain_size(block * rows * sizeof(T));
+
+			detail::parallel_for(num_col_blocks, grain, [&](size_t begin, size_t end)
+				{
+					for (size_t col_block = begin; col_block < end; ++col_block)
+					{
+						const size_t col_begin = col_block * block;
+						const size_t col_end = std::min(cols, col_begin + block);
+						for (size_t row_begin = 0; row_begin < rows; row_begin += block)
+						{
+							const size_t row_end = std::min(rows, row_begin + block);
+							for (size_t col = col_begin; col < col_end; ++col)
+							{
+								T* dst_row = dst + col * rows;
+								for (size_t row = row_begin; row < row_end; ++row)
+								{
+									dst_row[row] = src[row * cols + col];
+								}
+							}
+						}
+					}
+				});
+		}
+
 		namespace from_py
 		{
+			/// Non-throwing validation of a 1 or 2d input array against the expected width and height. This performs
+			/// the same checks as the shape validation in vector() and view() without allocating or formatting messages.
+			template <typename T>
+			validation_error try_validate(const py::array_t<T>& data, size_t expected_width, size_t expected_height) noexcept
+			{
+				constexpr std::array<size_t, 2> allowed_dims = { 1, 2 };
+				if (auto error = detail::try_check_py_array_dims(data, allowed_dims, expected_height * expected_width))
+				{
+					return error;
+				}
+
+				// The dimensions were validated above so we can gather the shape on the stack
+				std::array<size_t, 2> shape = {};
+				const auto ndim = static_cast<size_t>(data.ndim());
+				for (size_t i = 0; i < ndim; ++i)
+				{
+					shape[i] = static_cast<size_t>(data.shape(i));
+				}
+				return detail::try_check_shape(std::span<const size_t>(shape.data(), ndim), expected_width, expected_height);
+			}
+
+			/// Validate that the shape of a 1 or 2d input array matches the expected width and height. Does not 
+			/// allocate unless the validation fails.
+			/// 
+			/// \throws py::value_error if the number of dimensions or the shape does not match
+			template <typename T>
+			void validate_shape(const py::array_t<T>& data, size_t expected_width, size_t expected_height)
+			{
+				if (auto error = try_validate(data, expected_width, expected_height))
+				{
+					throw py::value_error(error.message());
+				}
+			}
+
+			/// Validate a 1 or 2d input array against the expected width and height according to the validation policy.
+			/// With policy::checked this validates the shape, forcecasts to c-style ordering if the data is not contiguous 
+			/// and checks the data is not null. policy::debug only asserts these conditions and policy::unchecked skips
+			/// them entirely.
+			/// 
+			/// The forcecast rebinds `data` to the converted array, the entry points therefore pass a local copy of the
+			/// callers' handle so their array is never modified (see the "Free-threaded python" section of the README).
+			template <validation_policy Policy, typename T>
+			void validate([[maybe_unused]] py::array_t<T>& data, [[maybe_unused]] size_t expected_width, [[maybe_unused]] size_t expected_height)
+			{
+				if constexpr (std::is_same_v<Policy, policy::checked>)
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("validate", data);
+					validate_shape(data, expected_width, expected_height);
+					detail::check_c_style_contiguous(data);
+					detail::check_not_null(data);
+				}
+				else if constexpr (std::is_same_v<Policy, policy::debug>)
+				{
+					assert(!try_validate(data, expected_width, expected_height) && "Invalid numpy array shape passed with policy::debug");
+					assert(detail::is_c_style_contiguous(data) && "Non C-contiguous numpy array passed with policy::debug");
+					assert(data.data() != nullptr);
+				}
+			}
+
+			/// Validate a 1 or 2d input array that is about to be copied according to the validation policy. Unlike 
+			/// validate() this does not forcecast Fortran-ordered input (e.g. arr.T) with policy::checked as 
+			/// copy_validated() transposes it straight into the output instead, saving a temporary c-style array which
+			/// we would then have to copy a second time.
+			/// 
+			/// \return Whether the array is Fortran-ordered and has to be transposed by copy_validated()
+			template <validation_policy Policy, typename T>
+			bool validate_for_copy(py::array_t<T>& data, size_t expected_width, size_t expected_height)
+			{
+				if constexpr (std::is_same_v<Policy, policy::checked>)
+				{
+					if (detail::is_f_style_contiguous(data) && !detail::is_c_style_contiguous(data))
+					{
+						validate_shape(data, expected_width, expected_height);
+						detail::check_not_null(data);
+						return true;
+					}
+				}
+				validate<Policy>(data, expected_width, expected_height);
+				return false;
+			}
+
+			/// Copy the array validated by validate_for_copy() into dst which must hold expected_width * expected_height
+			/// elements.
+			template <typename T>
+			void copy_validated(py::array_t<T>& data, size_t expected_width, size_t expected_height, T* dst, bool transpose)
+			{
+				if (transpose)
+				{
+					// A Fortran-ordered [height, width] array is laid out like a c-style [width, height] array
+					PY_IMG_UTIL_TRACE_SCOPE("transpose", data);
+					py::gil_scoped_release release;
+					detail::transpose_blocked(data.data(), dst, expected_width, expected_height);
+					return;
+				}
+				// `data` keeps the buffer alive and the shape was validated, so the copy itself does not need the GIL
+				PY_IMG_UTIL_TRACE_SCOPE("copy", data);
+				py::gil_scoped_release release;
+				detail::copy_elements(data.data(), dst, expected_height * expected_width);
+			}
+
 			/// Generate a vector from the python np array copying the data into the new container
 			/// Generates a flat vector over a 1 or 2d input array. If the incoming data is not contiguous we forcecast
 			/// to c-style ordering as well as asserting that the data matches expected_size
-			template <typename T>
-			std::vector<T> vector(py::array_t<T>& data, size_t expected_width, size_t expected_height)
+			template <typename T, validation_policy Policy = policy::checked>
+			std::vector<T> vector(const py::array_t<T>& data, size_t expected_width, size_t expected_height, [[maybe_unused]] Policy policy = {})
 			{
-				size_t expected_size = expected_height * expected_width;
+				// Validate on a local handle, a forcecast rebinds it and must never be visible to the caller or other threads
+				py::array_t<T> source = data;
 				// This checks that the size matches so we can safely construct assume expected_size
 				// is the actual size from this point onwards
-				auto shape = detail::shape_from_py_array(data, { 1, 2 }, expected_size);
-				detail::check_shape(shape, expected_width, expected_height);
-				detail::check_c_style_contiguous(data);
-				detail::check_not_null(data);
+				const bool transpose = validate_for_copy<Policy>(source, expected_width, expected_height);
 
 				// Finally convert the channel to a cpp vector and return
-				std::vector<T> data_vec(expected_size);
-				std::memcpy(data_vec.data(), data.data(), expected_size * sizeof(T));
+				std::vector<T> data_vec;
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("alloc", source);
+					data_vec.resize(expected_height * expected_width);
+				}
+				copy_validated(source, expected_width, expected_height, data_vec.data(), transpose);
+				return data_vec;
+			}
+
+			/// Copy the python np array into an existing vector, reusing its storage. The vector is resized to 
+			/// expected_width * expected_height elements which only allocates if its capacity is insufficient, so
+			/// repeatedly converting same-sized arrays into the same vector does not allocate. Validation is 
+			/// identical to vector().
+			template <typename T, typename Alloc, validation_policy Policy = policy::checked>
+			void vector_into(const py::array_t<T>& data, size_t expected_width, size_t expected_height, std::vector<T, Alloc>& out, [[maybe_unused]] Policy policy = {})
+			{
+				py::array_t<T> source = data;
+				const bool transpose = validate_for_copy<Policy>(source, expected_width, expected_height);
+				out.resize(expected_height * expected_width);
+				copy_validated(source, expected_width, expected_height, out.data(), transpose);
+			}
+
+			/// Copy the python np array into a caller provided span which must hold exactly expected_width * 
+			/// expected_height elements. Validation is identical to vector().
+			/// 
+			/// \throws py::value_error if the span size does not match (with policy::checked)
+			template <typename T, validation_policy Policy = policy::checked>
+			void span_into(const py::array_t<T>& data, size_t expected_width, size_t expected_height, std::span<T> out, [[maybe_unused]] Policy policy = {})
+			{
+				py::array_t<T> source = data;
+				const bool transpose = validate_for_copy<Policy>(source, expected_width, expected_height);
+				if constexpr (std::is_same_v<Policy, policy::checked>)
+				{
+					if (out.size() != expected_height * expected_width)
+					{
+						throw py::value_error(
+							std::format(
+								"Unable to convert numpy array into the provided span as it holds {:L} elements while {:L} are required",
+								out.size(), expected_height * expected_width
+							)
+						);
+					}
+				}
+				else if constexpr (std::is_same_v<Policy, policy::debug>)
+				{
+					assert(out.size() == expected_height * expected_width && "Span of invalid size passed with policy::debug");
+				}
+				copy_validated(source, expected_width, expected_height, out.data(), transpose);
+			}
+
+			/// Generate a huge_vector from the python np array copying the data into the new container. Buffers above 
+			/// huge_page_threshold() are backed by transparent huge pages and filled by a parallel copy with the GIL 
+			/// released, so the first touch of the pages is spread across threads. Validation is identical to vector().
+			template <typename T, validation_policy Policy = policy::checked>
+			huge_vector<T> huge(const py::array_t<T>& data, size_t expected_width, size_t expected_height, [[maybe_unused]] Policy policy = {})
+			{
+				py::array_t<T> source = data;
+				validate<Policy>(source, expected_width, expected_height);
+
+				size_t expected_size = expected_height * expected_width;
+				huge_vector<T> data_vec(expected_size);
+				const T* src = source.data();
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("copy", source);
+					py::gil_scoped_release release;
+					detail::parallel_copy(src, data_vec.data(), expected_size);
+				}
 				return data_vec;
 			}
 
@@ -53,38 +273,356 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 			/// to c-style ordering as well as asserting that the data matches expected_size
 			/// 
 			/// \param data The python numpy based array we want to create a view over
-			/// \param expected_size The expected size in number of elements, NOT bytes.
-			template <typename T>
-			const std::span<const T> view(py::array_t<T>& data, size_t expected_width, size_t expected_height)
+			/// \param expected_width The expected width in number of elements, NOT bytes.
+			/// \param expected_height The expected height in number of elements.
+			template <typename T, validation_policy Policy = policy::checked>
+			const std::span<const T> view(py::array_t<T>& data, size_t expected_width, size_t expected_height, [[maybe_unused]] Policy policy = {})
 			{
 				size_t expected_size = expected_height * expected_width;
 				// This checks that the size matches so we can safely construct assume expected_size
 				// is the actual size from this point onwards
-				auto shape = detail::shape_from_py_array(data, { 1, 2 }, expected_size);
-				detail::check_shape(shape, expected_width, expected_height);
-				detail::check_c_style_contiguous(data);
-				detail::check_not_null(data);
+				validate<Policy>(data, expected_width, expected_height);
 
 				// Finally convert the channel to a cpp span and return
 				std::span<const T> data_span(data.data(), expected_size);
 				return data_span;
 			}
 
+			/// Generate a per-channel view over the data from a 3d planar python array of shape [channels, height, width].
+			/// Like view() this does not copy and the result should only be used for immediate construction as 
+			/// memory management is not guaranteed. If the incoming data is not contiguous we forcecast to c-style
+			/// ordering.
+			/// 
+			/// \param data The python numpy based array we want to create a view over
+			/// \param expected_channels The expected number of channels
+			/// \param expected_width The expected width in number of elements, NOT bytes.
+			/// \param expected_height The expected height in number of elements.
+			template <typename T, validation_policy Policy = policy::checked>
+			planar_view<T> planar(py::array_t<T>& data, size_t expected_channels, size_t expected_width, size_t expected_height, [[maybe_unused]] Policy policy = {})
+			{
+				size_t expected_size = expected_channels * expected_height * expected_width;
+				if constexpr (std::is_same_v<Policy, policy::checked>)
+				{
+					auto shape = detail::shape_from_py_array(data, { 3 }, expected_size);
+					detail::check_shape_3d(shape, expected_channels, expected_width, expected_height);
+					detail::check_c_style_contiguous(data);
+					detail::check_not_null(data);
+				}
+				else if constexpr (std::is_same_v<Policy, policy::debug>)
+				{
+					assert(data.ndim() == 3 && static_cast<size_t>(data.size()) == expected_size);
+					assert(detail::is_c_style_contiguous(data) && "Non C-contiguous numpy array passed with policy::debug");
+					assert(data.data() != nullptr);
+				}
+
+				return planar_view<T>(std::span<const T>(data.data(), expected_size), expected_channels, expected_width, expected_height);
+			}
+
+			/// Non-throwing equivalent of vector(), returns the validation error instead of raising a py::value_error.
+			template <typename T>
+			validation_result<std::vector<T>> try_vector(const py::array_t<T>& data, size_t expected_width, size_t expected_height)
+			{
+				py::array_t<T> source = data;
+				if (auto error = try_validate(source, expected_width, expected_height))
+				{
+					return error;
+				}
+				detail::check_c_style_contiguous(source);
+				if (auto error = detail::try_check_not_null(source))
+				{
+					return error;
+				}
+
+				size_t expected_size = expected_height * expected_width;
+				std::vector<T> data_vec(expected_size);
+				std::memcpy(data_vec.data(), source.data(), expected_size * sizeof(T));
+				return data_vec;
+			}
+
+			/// Non-throwing equivalent of view(), returns the validation error instead of raising a py::value_error.
+			template <typename T>
+			validation_result<std::span<const T>> try_view(py::array_t<T>& data, size_t expected_width, size_t expected_height)
+			{
+				if (auto error = try_validate(data, expected_width, expected_height))
+				{
+					return error;
+				}
+				detail::check_c_style_contiguous(data);
+				if (auto error = detail::try_check_not_null(data))
+				{
+					return error;
+				}
+				return std::span<const T>(data.data(), expected_height * expected_width);
+			}
+
+			/// Generate a typed_image from the python np array copying the data into the new container. The array
+			/// must match the images' numpy shape exactly, i.e. [channels, height, width] for planar images, 
+			/// [height, width, channels] for interleaved images and [height, width] for single channel images.
+			/// If the incoming data is not contiguous we forcecast to c-style ordering.
+			template <typename Image>
+				requires is_typed_image_v<Image>
+			Image typed(const py::array_t<typename Image::value_type>& data, size_t expected_width, size_t expected_height)
+			{
+				using T = typename Image::value_type;
+				py::array_t<T> source = data;
+				detail::check_shape_exact(source, Image::shape_for(expected_width, expected_height));
+				detail::check_c_style_contiguous(source);
+				detail::check_not_null(source);
+
+				Image image(expected_width, expected_height);
+				std::memcpy(image.data().data(), source.data(), image.data().size() * sizeof(T));
+				return image;
+			}
+
+			/// Generate a sparse_image from the python np array, uniform tiles are detected while scanning the
+			/// array and only the remaining tiles are copied. The scan runs in parallel with the GIL released.
+			/// If the incoming data is not contiguous we forcecast to c-style ordering.
+			/// 
+			/// \param data The python numpy based array to convert
+			/// \param expected_width The expected width in number of elements, NOT bytes.
+			/// \param expected_height The expected height in number of elements.
+			/// \param tile_size The size of the square tiles in pixels
+			template <typename T, validation_policy Policy = policy::checked>
+			sparse_image<T> sparse(const py::array_t<T>& data, size_t expected_width, size_t expected_height, size_t tile_size, [[maybe_unused]] Policy policy = {})
+			{
+				py::array_t<T> source = data;
+				validate<Policy>(source, expected_width, expected_height);
+				std::span<const T> data_span(source.data(), expected_width * expected_height);
+
+				PY_IMG_UTIL_TRACE_SCOPE("sparse", source);
+				py::gil_scoped_release release;
+				return sparse_image<T>::from_dense(data_span, expected_width, expected_height, tile_size);
+			}
+
+			/// Pack the python np array into a packed_image with `Bits` bits per sample. Rows are packed in parallel 
+			/// with the GIL released. If the incoming data is not contiguous we forcecast to c-style ordering.
+			/// 
+			/// \param data The python numpy based array to convert
+			/// \param expected_width The expected width in number of elements, NOT bytes.
+			/// \param expected_height The expected height in number of elements.
+			/// 
+			/// \throws py::value_error if any sample does not fit into `Bits` bits
+			template <size_t Bits, typename T, validation_policy Policy = policy::checked>
+				requires std::is_integral_v<T>
+			packed_image<Bits> packed(const py::array_t<T>& data, size_t expected_width, size_t expected_height, [[maybe_unused]] Policy policy = {})
+			{
+				py::array_t<T> source = data;
+				validate<Policy>(source, expected_width, expected_height);
+				packed_image<Bits> image(expected_width, expected_height);
+				const T* src = source.data();
+				std::atomic<uint64_t> overflow = 0;
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("pack", source);
+					py::gil_scoped_release release;
+					const size_t grain = detail::parallel_grain_size(expected_width * sizeof(T));
+					detail::parallel_for(expected_height, grain, [&](size_t begin, size_t end)
+						{
+							uint64_t local_overflow = 0;
+							for (size_t y = begin; y < end; ++y)
+							{
+								local_overflow |= detail::pack_row<Bits>(src + y * expected_width, image.row(y).data(), expected_width);
+							}
+							overflow.fetch_or(local_overflow, std::memory_order_relaxed);
+						});
+				}
+				if (overflow.load(std::memory_order_relaxed) != 0)
+				{
+					throw py::value_error(
+						std::format(
+							"Unable to pack numpy array into {} bits per sample as it holds values outside of the range [0, {}]",
+							Bits, packed_image<Bits>::max_value
+						)
+					);
+				}
+				return image;
+			}
+
+			/// Encode the python np array row by row with PackBits RLE without first copying it into an intermediate
+			/// buffer. Bands of rows are encoded in parallel with the GIL released. If the incoming data is not
+			/// contiguous we forcecast to c-style ordering.
+			/// 
+			/// \param data The python numpy based array to convert
+			/// \param expected_width The expected width in number of elements, NOT bytes.
+			/// \param expected_height The expected height in number of elements.
+			template <typename T, validation_policy Policy = policy::checked>
+			encoded_image packbits(const py::array_t<T>& data, size_t expected_width, size_t expected_height, [[maybe_unused]] Policy policy = {})
+			{
+				py::array_t<T> source = data;
+				validate<Policy>(source, expected_width, expected_height);
+				const T* src = source.data();
+
+				PY_IMG_UTIL_TRACE_SCOPE("packbits", source);
+				py::gil_scoped_release release;
+				return detail::packbits_encode_image(src, expected_width, expected_height);
+			}
+
+			/// Delta-predict the python np array row by row without first copying it into an intermediate buffer, 
+			/// the output is ready to be passed to a deflate compressor. Rows are predicted in parallel with the GIL
+			/// released. If the incoming data is not contiguous we forcecast to c-style ordering.
+			/// 
+			/// \param data The python numpy based array to convert
+			/// \param expected_width The expected width in number of elements, NOT bytes.
+			/// \param expected_height The expected height in number of elements.
+			template <typename T, validation_policy Policy = policy::checked>
+				requires is_delta_encodable_v<T>
+			encoded_image delta(const py::array_t<T>& data, size_t expected_width, size_t expected_height, [[maybe_unused]] Policy policy = {})
+			{
+				py::array_t<T> source = data;
+				validate<Policy>(source, expected_width, expected_height);
+				const T* src = source.data();
+
+				PY_IMG_UTIL_TRACE_SCOPE("delta", source);
+				py::gil_scoped_release release;
+				return detail::delta_encode_image(src, expected_width, expected_height);
+			}
+
 		} // from_py
 
 		namespace to_py
 		{
 
+			/// A vector owned by a py::capsule along with its memory accounting, see memory.h
+			template <typename T, typename Alloc = std::allocator<T>>
+			struct owned_vector
+			{
+				std::vector<T, Alloc> data;
+				memory_token token;
+			};
+
+			/// Move the vector into a heap allocation owned by a py::capsule, the vector (and with it its data)
+			/// is freed once the last python object referencing the capsule dies. The vectors' data pointer
+			/// is unchanged by this operation. If memory tracking is enabled the buffer is accounted until then.
+			/// 
+			/// \param data The vector to take ownership of
+			template <typename T, typename Alloc>
+			py::capsule capsule_from_vector(std::vector<T, Alloc>&& data)
+			{
+				// We generate a temporary unique_ptr to assign to the capsule
+				// so that the array_t can take ownership over our data
+				const size_t bytes = data.capacity() * sizeof(T);
+				PY_IMG_UTIL_TRACE_SCOPE("capsule", trace::dtype_name<T>(), std::span<const size_t>{}, bytes);
+				auto data_ptr = std::make_unique<owned_vector<T, Alloc>>(std::move(data), memory_token(bytes));
+				auto capsule = py::capsule(data_ptr.get(), [](void* p)
+					{
+						std::unique_ptr<owned_vector<T, Alloc>>(reinterpret_cast<owned_vector<T, Alloc>*>(p));
+					});
+				data_ptr.release();
+				return capsule;
+			}
+
+			/// Generate a py::capsule sharing ownership of the vector, the capsule holds a reference to the buffer 
+			/// which is released once the last python object referencing the capsule dies. As the C++ side co-owns
+			/// the buffer it is not accounted by the memory tracking.
+			/// 
+			/// \param data The shared vector to hold a reference to
+			template <typename T>
+			py::capsule capsule_from_shared(std::shared_ptr<const std::vector<T>> data)
+			{
+				auto data_ptr = std::make_unique<std::shared_ptr<const std::vector<T>>>(std::move(data));
+				auto capsule = py::capsule(data_ptr.get(), [](void* p)
+					{
+						std::unique_ptr<std::shared_ptr<const std::vector<T>>>(reinterpret_cast<std::shared_ptr<const std::vector<T>>*>(p));
+					});
+				data_ptr.release();
+				return capsule;
+			}
+
+			/// Memory owned elsewhere which is lent to a py::capsule, `release` is called with `context` once the capsule
+			/// dies. Carries the memory accounting for as long as python references the memory, see memory.h
+			struct borrowed_buffer
+			{
+				void* context = nullptr;
+				void (*release)(void*) = nullptr;
+				memory_token token;
+			};
+
+			/// Generate a py::capsule lending memory owned elsewhere to python, `release(context)` is called once the last
+			/// python object referencing the capsule dies. If memory tracking is enabled the memory is accounted until then.
+			/// 
+			/// \param context The pointer passed to release
+			/// \param release Called exactly once when python no longer references the memory, must not throw
+			/// \param bytes The size of the lent memory in bytes
+			inline py::capsule capsule_from_borrowed(void* context, void (*release)(void*), size_t bytes)
+			{
+				auto data_ptr = std::make_unique<borrowed_buffer>(context, release, memory_token(bytes));
+				auto capsule = py::capsule(data_ptr.get(), [](void* p)
+					{
+						auto buffer = std::unique_ptr<borrowed_buffer>(reinterpret_cast<borrowed_buffer*>(p));
+						void* context = buffer->context;
+						auto release = buffer->release;
+						// The accounting ends before the memory is handed back, the release may free it
+						buffer.reset();
+						release(context);
+					});
+				data_ptr.release();
+				return capsule;
+			}
+
+			/// Mark the numpy array as read-only, any attempt to write to it from python raises a ValueError
+			inline void set_readonly(py::array& array)
+			{
+				// Goes through the public numpy API rather than pybinds' internal array_proxy whose layout is not stable
+				array.attr("setflags")(py::arg("write") = false);
+			}
+
+			/// Allocate an uninitialized c-style py::array_t of the given shape for the caller to fill. Buffers of at least 
+			/// huge_page_threshold() bytes are backed by a huge_vector owned by a capsule so that filling them in 
+			/// parallel faults in huge pages across threads, smaller ones are allocated by numpy.
+			/// 
+			/// \param shape The shape of the output container
+			template <typename T, typename Shape>
+			py::array_t<T> allocate_array(const Shape& shape)
+			{
+				const size_t size = std::accumulate(shape.begin(), shape.end(), size_t{ 1 }, std::multiplies<size_t>());
+				if (size * sizeof(T) < huge_page_threshold())
+				{
+					return py::array_t<T>(shape);
+				}
+
+				huge_vector<T> buffer(size);
+				const std::vector<size_t> shape_vec(shape.begin(), shape.end());
+				auto strides = detail::strides_from_shape<T>(shape_vec);
+				auto data_raw_ptr = buffer.data();
+				auto capsule = capsule_from_vector(std::move(buffer));
+				return py::array(shape_vec, strides, data_raw_ptr, capsule);
+			}
+
+			/// Copy the (already validated) data into a new py::array_t. Buffers above huge_page_threshold() are copied
+			/// in parallel with the GIL released into a huge page backed buffer owned by a capsule, smaller ones are
+			/// copied into a regular numpy-owned buffer.
+			/// 
+			/// \param data The span to copy the data from
+			/// \param shape The shape to assign to the output container
+			template <typename T>
+			py::array_t<T> copy_into_array(std::span<const T> data, const std::vector<size_t>& shape)
+			{
+				PY_IMG_UTIL_TRACE_SCOPE("copy", trace::dtype_name<T>(), shape, data.size_bytes());
+				if (data.size_bytes() < huge_page_threshold())
+				{
+					return py::array_t<T>(shape, data.data());
+				}
+
+				huge_vector<T> buffer(data.size());
+				{
+					py::gil_scoped_release release;
+					detail::parallel_copy(data.data(), buffer.data(), data.size());
+				}
+				auto strides = detail::strides_from_shape<T>(shape);
+				auto data_raw_ptr = buffer.data();
+				auto capsule = capsule_from_vector(std::move(buffer));
+				return py::array(shape, strides, data_raw_ptr, capsule);
+			}
+
 			/// Generate a py::array_t from std::vector copying the data into 
 			/// its internal buffer. This will create a copy of the cpp data.
 			/// 
 			/// \param data The vector to copy the data from
 			/// \param shape The shape to assign to the output container
-			template <typename T>
-			py::array_t<T> from_vector(const std::vector<T>& data, std::vector<size_t> shape)
+			template <typename T, validation_policy Policy = policy::checked>
+			py::array_t<T> from_vector(const std::vector<T>& data, std::vector<size_t> shape, [[maybe_unused]] Policy policy = {})
 			{
-				detail::check_cpp_vec_matches_shape(data, shape);
-				return py::array_t<T>(shape, data.data());
+				detail::validate_cpp_span_matches_shape<Policy>(std::span<const T>(data), shape);
+				return copy_into_array(std::span<const T>(data), shape);
 			}
 
 			/// Generate a py::array_t from std::vector move constructing the data. Will let the python object
@@ -92,35 +630,453 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 			/// 
 			/// \param data The vector to copy the data from
 			/// \param shape The shape to assign to the output container
-			template <typename T>
-			py::array_t<T> from_vector(std::vector<T>&& data, std::vector<size_t> shape)
+			template <typename T, typename Alloc, validation_policy Policy = policy::checked>
+			py::array_t<T> from_vector(std::vector<T, Alloc>&& data, std::vector<size_t> shape, [[maybe_unused]] Policy policy = {})
 			{
-				detail::check_cpp_vec_matches_shape(data, shape);
+				detail::validate_cpp_span_matches_shape<Policy>(std::span<const T>(data), shape);
 				auto strides = detail::strides_from_shape<T>(shape);
 
-				// We generate a temporary unique_ptr to assign to the capsule
-				// so that the array_t can take ownership over our data
+				// Moving the vector keeps its buffer in place so we can grab the pointer up front
 				auto data_raw_ptr = data.data();
-				auto data_ptr = std::make_unique<std::vector<T>>(std::move(data));
-				auto capsule = py::capsule(data_ptr.get(), [](void* p)
-					{
-						std::unique_ptr<std::vector<T>>(reinterpret_cast<decltype(data_ptr)::element_type*>(p));
-					});
-				data_ptr.release();
+				auto capsule = capsule_from_vector(std::move(data));
 				// Implicitly convert from py::array to py::array_t as they inherit from one another
 				return py::array(shape, strides, data_raw_ptr, capsule);
 			}
 
+			/// Generate a py::array_t over memory owned elsewhere without copying, e.g. a preallocated slot which is 
+			/// recycled by `release(context)` once python no longer references the array. The memory must stay valid 
+			/// until then.
+			/// 
+			/// \param data The memory to expose
+			/// \param shape The shape to assign to the output container
+			/// \param context The pointer passed to release
+			/// \param release Called exactly once when the last python reference dies, must not throw
+			template <typename T, validation_policy Policy = policy::checked>
+			py::array_t<T> from_borrowed(std::span<T> data, std::vector<size_t> shape, void* context, void (*release)(void*), [[maybe_unused]] Policy policy = {})
+			{
+				detail::validate_cpp_span_matches_shape<Policy>(std::span<const T>(data), shape);
+				PY_IMG_UTIL_TRACE_SCOPE("capsule", trace::dtype_name<T>(), shape, data.size_bytes());
+				auto strides = detail::strides_from_shape<T>(shape);
+				auto capsule = capsule_from_borrowed(context, release, data.size_bytes());
+				return py::array(shape, strides, data.data(), capsule);
+			}
+
+			/// Generate a read-only py::array_t sharing the buffer with the C++ side without copying. The array 
+			/// keeps the buffer alive through its capsule, the data must not be modified by the C++ side while python 
+			/// holds a reference to it.
+			/// 
+			/// \param data The shared vector to expose
+			/// \param shape The shape to assign to the output container
+			template <typename T, validation_policy Policy = policy::checked>
+			py::array_t<T> from_shared(std::shared_ptr<const std::vector<T>> data, std::vector<size_t> shape, [[maybe_unused]] Policy policy = {})
+			{
+				if (!data)
+				{
+					throw py::value_error("Unable to generate a numpy array from a null shared buffer");
+				}
+				detail::validate_cpp_span_matches_shape<Policy>(std::span<const T>(*data), shape);
+				auto strides = detail::strides_from_shape<T>(shape);
+
+				auto data_raw_ptr = data->data();
+				auto capsule = capsule_from_shared(std::move(data));
+				py::array array(shape, strides, data_raw_ptr, capsule);
+				set_readonly(array);
+				return array;
+			}
+
+			/// Generate a py::array_t from a vector with padded rows move constructing the data. Will let the python
+			/// object take ownership of the data without compacting it, the padding is skipped via the arrays' strides.
+			/// 
+			/// \param data The vector to move the data from
+			/// \param width The width of the image in number of elements
+			/// \param height The height of the image in number of elements
+			/// \param pitch The distance between the start of two rows
+			template <typename T, validation_policy Policy = policy::checked>
+			py::array_t<T> from_pitched_vector(std::vector<T>&& data, size_t width, size_t height, row_pitch pitch, [[maybe_unused]] Policy policy = {})
+			{
+				detail::validate_cpp_span_matches_pitch<Policy>(std::span<const T>(data), width, height, pitch);
+				std::array<size_t, 2> shape = { height, width };
+				std::array<size_t, 2> strides = { pitch.bytes, sizeof(T) };
+
+				auto data_raw_ptr = data.data();
+				auto capsule = capsule_from_vector(std::move(data));
+				return py::array(shape, strides, data_raw_ptr, capsule);
+			}
+
+			/// Generate a compact py::array_t from a buffer with padded rows copying the data into its internal buffer.
+			/// The padding is stripped during the copy which is parallelized over the rows with the GIL released.
+			/// 
+			/// \param data The span to copy the data from
+			/// \param width The width of the image in number of elements
+			/// \param height The height of the image in number of elements
+			/// \param pitch The distance between the start of two rows
+			template <typename T, validation_policy Policy = policy::checked>
+			py::array_t<T> from_pitched_view(const std::span<const T> data, size_t width, size_t height, row_pitch pitch, [[maybe_unused]] Policy policy = {})
+			{
+				detail::validate_cpp_span_matches_pitch<Policy>(data, width, height, pitch);
+				std::array<size_t, 2> shape = { height, width };
+				py::array_t<T> out = allocate_array<T>(shape);
+				T* out_ptr = out.mutable_data();
+				const T* in_ptr = data.data();
+				const size_t pitch_elements = pitch.elements<T>();
+
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("copy", trace::dtype_name<T>(), shape, width * height * sizeof(T));
+					py::gil_scoped_release release;
+					const size_t grain = detail::parallel_grain_size(width * sizeof(T));
+					detail::parallel_for(height, grain, [&](size_t begin, size_t end)
+						{
+							for (size_t y = begin; y < end; ++y)
+							{
+								std::memcpy(out_ptr + y * width, in_ptr + y * pitch_elements, width * sizeof(T));
+							}
+						});
+				}
+				return out;
+			}
+
+			/// Generate a py::array_t from a typed_image copying the data into its internal buffer.
+			/// The shape and strides are derived from the images' compile-time layout.
+			/// 
+			/// \param image The image to copy the data from
+			template <typename T, layout Layout, size_t Channels>
+			py::array_t<T> from_typed(const typed_image<T, Layout, Channels>& image)
+			{
+				const auto shape = image.shape();
+				const auto strides = image.strides();
+				const auto data = image.data();
+
+				py::array_t<T> out(shape, strides);
+				PY_IMG_UTIL_TRACE_SCOPE("copy", trace::dtype_name<T>(), shape, data.size() * sizeof(T));
+				std::memcpy(out.mutable_data(), data.data(), data.size() * sizeof(T));
+				return out;
+			}
+
+			/// Generate a py::array_t from a typed_image move constructing the data. Will let the python object
+			/// take ownership of the data.
+			/// 
+			/// \param image The image to move the data from
+			template <typename T, layout Layout, size_t Channels>
+			py::array_t<T> from_typed(typed_image<T, Layout, Channels>&& image)
+			{
+				const auto shape = image.shape();
+				const auto strides = image.strides();
+
+				auto data = std::move(image).release();
+				auto data_raw_ptr = data.data();
+				auto capsule = capsule_from_vector(std::move(data));
+				return py::array(shape, strides, data_raw_ptr, capsule);
+			}
+
 			/// Generate a py::array_t from std::vector copying the data into 
 			/// its internal buffer. This will create a copy of the cpp data.
 			/// 
 			/// \param data The span to copy the data from
 			/// \param shape The shape to assign to the output container
+			template <typename T, validation_policy Policy = policy::checked>
+			py::array_t<T> from_view(const std::span<const T> data, std::vector<size_t> shape, [[maybe_unused]] Policy policy = {})
+			{
+				detail::validate_cpp_span_matches_shape<Policy>(data, shape);
+				return copy_into_array(data, shape);
+			}
+
+			/// Generate a py::array_t<Out> of shape [height, width] quantizing the floating point data during the copy,
+			/// see quantization. Rows are quantized in parallel with the GIL released straight into the numpy buffer.
+			/// 
+			/// \param data The row-major source image
+			/// \param width The width of the source image
+			/// \param height The height of the source image
+			/// \param params The input range and dithering to apply
+			/// 
+			/// \throws py::value_error if the input range is empty or not finite
+			template <typename Out, typename T, validation_policy Policy = policy::checked>
+				requires is_quantizable_v<T, Out>
+			py::array_t<Out> quantized(const std::span<const T> data, size_t width, size_t height, quantization params, [[maybe_unused]] Policy policy = {})
+			{
+				const std::vector<size_t> shape{ height, width };
+				detail::validate_cpp_span_matches_shape<Policy>(data, shape);
+				const double range = params.high - params.low;
+				if (!std::isfinite(range) || range == 0.0)
+				{
+					throw py::value_error(
+						std::format("Unable to quantize from the input range [{}, {}] as it is empty or not finite", params.low, params.high)
+					);
+				}
+				const T scale = static_cast<T>(static_cast<double>(std::numeric_limits<Out>::max()) / range);
+				const T offset = static_cast<T>(-params.low * static_cast<double>(scale));
+
+				py::array_t<Out> out = allocate_array<Out>(shape);
+				Out* out_ptr = out.mutable_data();
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("quantize", trace::dtype_name<Out>(), shape, data.size_bytes());
+					py::gil_scoped_release release;
+					detail::parallel_for(height, detail::parallel_grain_size(width * sizeof(T)), [&](size_t begin, size_t end)
+						{
+							for (size_t y = begin; y < end; ++y)
+							{
+								const auto pattern = detail::quantize_dither_pattern<T>(y, params.dither);
+								detail::quantize_row(data.data() + y * width, out_ptr + y * width, width, scale, offset, pattern);
+							}
+						});
+				}
+				return out;
+			}
+
+			/// Generate a dense py::array_t of shape [height, width] from a sparse_image, the tiles are expanded 
+			/// in parallel with the GIL released.
+			/// 
+			/// \param image The sparse image to expand
+			template <typename T>
+			py::array_t<T> from_sparse(const sparse_image<T>& image)
+			{
+				const std::array<size_t, 2> shape = { image.height(), image.width() };
+				py::array_t<T> out = allocate_array<T>(shape);
+				std::span<T> out_span(out.mutable_data(), image.width() * image.height());
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("expand", trace::dtype_name<T>(), shape, out_span.size_bytes());
+					py::gil_scoped_release release;
+					image.expand_into(out_span);
+				}
+				return out;
+			}
+
+			/// Generate a py::array_t of shape [height, width] from a packed_image, unpacking each sample into its
+			/// own element. Rows are unpacked in parallel with the GIL released.
+			/// 
+			/// \param image The packed image to expand
+			template <size_t Bits>
+			py::array_t<typename packed_image<Bits>::sample_type> from_packed(const packed_image<Bits>& image)
+			{
+				using T = typename packed_image<Bits>::sample_type;
+				const std::array<size_t, 2> shape = { image.height(), image.width() };
+				py::array_t<T> out = allocate_array<T>(shape);
+				T* out_ptr = out.mutable_data();
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("unpack", trace::dtype_name<T>(), shape, image.width() * image.height() * sizeof(T));
+					py::gil_scoped_release release;
+					const size_t grain = detail::parallel_grain_size(image.width() * sizeof(T));
+					detail::parallel_for(image.height(), grain, [&](size_t begin, size_t end)
+						{
+							for (size_t y = begin; y < end; ++y)
+							{
+								detail::unpack_row<Bits>(image.row(y).data(), out_ptr + y * image.width(), image.width());
+							}
+						});
+				}
+				return out;
+			}
+
+			/// Generate the full resolution py::array_t followed by up to `levels` mip levels, each of shape [height, width].
+			/// All levels share a single allocation owned by one capsule. The full resolution copy and the first mip level
+			/// are generated in the same pass over the source rows so the source streams through the cache only once, 
+			/// the remaining (much smaller) levels are each generated from the previous one. Rows are processed in 
+			/// parallel with the GIL released.
+			/// 
+			/// \param data The row-major source image
+			/// \param width The width of the source image
+			/// \param height The height of the source image
+			/// \param levels The number of mip levels to generate in addition to the full resolution image
+			/// \param filter The filter used to reduce each level
+			template <typename T>
+			std::vector<py::array_t<T>> mip_chain(std::span<const T> data, size_t width, size_t height, size_t levels, mip_filter filter)
+			{
+				detail::check_cpp_span_matches_shape(data, std::vector<size_t>{ height, width });
+				const auto chain = detail::mip_chain_layout(width, height, levels);
+				const size_t total_size = chain.back().offset + chain.back().width * chain.back().height;
+
+				huge_vector<T> storage(total_size);
+				T* base = storage.data();
+				const T* src = data.data();
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("mip_chain", trace::dtype_name<T>(), std::array<size_t, 2>{ height, width }, total_size * sizeof(T));
+					py::gil_scoped_release release;
+					auto copy_rows = [&](size_t begin, size_t end)
+						{
+							if (begin < end && width > 0)
+							{
+								std::memcpy(base + begin * width, src + begin * width, (end - begin) * width * sizeof(T));
+							}
+						};
+
+					if (chain.size() == 1)
+					{
+						detail::parallel_for(height, detail::parallel_grain_size(width * sizeof(T)), copy_rows);
+					}
+					else
+					{
+						// Fused pass: copy each pair of source rows and reduce them into the first mip level
+						const auto& first = chain[1];
+						const size_t grain = detail::parallel_grain_size(2 * width * sizeof(T));
+						detail::parallel_for(first.height, grain, [&](size_t begin, size_t end)
+							{
+								for (size_t y = begin; y < end; ++y)
+								{
+									const size_t row0 = std::min(2 * y, height - 1);
+									const size_t row1 = std::min(2 * y + 1, height - 1);
+									copy_rows(row0, row1 + 1);
+									detail::downsample_row(src + row0 * width, src + row1 * width, base + first.offset + y * first.width, width, first.width, filter);
+								}
+							});
+						// Odd heights leave the last source row uncovered by the fused pass
+						copy_rows(std::min(2 * first.height, height), height);
+
+						for (size_t level = 2; level < chain.size(); ++level)
+						{
+							const auto& prev = chain[level - 1];
+							const auto& curr = chain[level];
+							detail::parallel_for(curr.height, detail::parallel_grain_size(2 * prev.width * sizeof(T)), [&](size_t begin, size_t end)
+								{
+									for (size_t y = begin; y < end; ++y)
+									{
+										const T* row0 = base + prev.offset + std::min(2 * y, prev.height - 1) * prev.width;
+										const T* row1 = base + prev.offset + std::min(2 * y + 1, prev.height - 1) * prev.width;
+										detail::downsample_row(row0, row1, base + curr.offset + y * curr.width, prev.width, curr.width, filter);
+									}
+								});
+						}
+					}
+				}
+
+				auto capsule = capsule_from_vector(std::move(storage));
+				std::vector<py::array_t<T>> out;
+				out.reserve(chain.size());
+				for (const auto& level : chain)
+				{
+					const std::array<size_t, 2> shape = { level.height, level.width };
+					const std::array<size_t, 2> strides = { level.width * sizeof(T), sizeof(T) };
+					out.push_back(py::array(shape, strides, base + level.offset, capsule));
+				}
+				return out;
+			}
+
+			/// Copy a row-major buffer into a rectangular region of an existing 2D or 3D interleaved numpy array. Rows 
+			/// are copied with a single memcpy each if the targets' rows are contiguous and element by element following
+			/// the targets' strides otherwise. Rows are copied in parallel with the GIL released.
+			/// 
+			/// \param target The array to paste into
+			/// \param data The buffer of width * height * channels elements to paste
+			/// \param x The column of the top left corner of the region
+			/// \param y The row of the top left corner of the region
+			/// \param width The width of the region
+			/// \param height The height of the region
+			template <typename T>
+			void paste(py::array_t<T>& target, std::span<const T> data, size_t x, size_t y, size_t width, size_t height)
+			{
+				detail::check_roi_in_bounds(target, x, y, width, height);
+				const size_t channels = target.ndim() == 3 ? static_cast<size_t>(target.shape(2)) : 1;
+				detail::check_cpp_span_matches_shape(data, std::vector<size_t>{ height, width, channels });
+
+				const auto row_stride = static_cast<std::ptrdiff_t>(target.strides(0));
+				const auto col_stride = static_cast<std::ptrdiff_t>(target.strides(1));
+				const auto channel_stride = target.ndim() == 3 ? static_cast<std::ptrdiff_t>(target.strides(2)) : static_cast<std::ptrdiff_t>(sizeof(T));
+				const bool contiguous_rows = channel_stride == static_cast<std::ptrdiff_t>(sizeof(T)) 
+					&& col_stride == static_cast<std::ptrdiff_t>(channels * sizeof(T));
+
+				auto* target_base = reinterpret_cast<std::byte*>(target.mutable_data())
+					+ static_cast<std::ptrdiff_t>(y) * row_stride + static_cast<std::ptrdiff_t>(x) * col_stride;
+				const T* src = data.data();
+				const size_t row_size = width * channels;
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("paste", trace::dtype_name<T>(), std::array<size_t, 3>{ height, width, channels }, data.size_bytes());
+					py::gil_scoped_release release;
+					detail::parallel_for(height, detail::parallel_grain_size(row_size * sizeof(T)), [&](size_t begin, size_t end)
+						{
+							for (size_t row = begin; row < end; ++row)
+							{
+								std::byte* dst_row = target_base + static_cast<std::ptrdiff_t>(row) * row_stride;
+								const T* src_row = src + row * row_size;
+								if (contiguous_rows)
+								{
+									std::memcpy(dst_row, src_row, row_size * sizeof(T));
+									continue;
+								}
+								for (size_t col = 0; col < width; ++col)
+								{
+									for (size_t c = 0; c < channels; ++c)
+									{
+										std::byte* dst = dst_row + static_cast<std::ptrdiff_t>(col) * col_stride + static_cast<std::ptrdiff_t>(c) * channel_stride;
+										std::memcpy(dst, src_row + col * channels + c, sizeof(T));
+									}
+								}
+							}
+						});
+				}
+			}
+
+			/// Generate a single 3D py::array_t from a number of equally sized channels copying the data into 
+			/// its internal buffer. The array is allocated once and the channels are filled in parallel with the 
+			/// GIL released.
+			/// 
+			/// \param channels The channels to copy, each must hold width * height elements in row-major order
+			/// \param width The width of each channel
+			/// \param height The height of each channel
+			/// \param out_layout Whether to generate a planar [C, H, W] or interleaved [H, W, C] array
 			template <typename T>
-			py::array_t<T> from_view(const std::span<const T> data, std::vector<size_t> shape)
+			py::array_t<T> from_channels(std::span<const std::span<const T>> channels, size_t width, size_t height, layout out_layout)
 			{
-				detail::check_cpp_span_matches_shape(data, shape);
-				return py::array_t<T>(shape, data.data());
+				if (channels.empty())
+				{
+					throw py::value_error("Unable to generate a numpy array from zero channels");
+				}
+				const std::vector<size_t> channel_shape{ height, width };
+				for (const auto& channel : channels)
+				{
+					detail::check_cpp_span_matches_shape(channel, channel_shape);
+				}
+
+				const size_t num_channels = channels.size();
+				std::vector<size_t> shape;
+				if (out_layout == layout::planar)
+				{
+					shape = { num_channels, height, width };
+				}
+				else
+				{
+					shape = { height, width, num_channels };
+				}
+				py::array_t<T> out = allocate_array<T>(shape);
+				T* out_ptr = out.mutable_data();
+
+				{
+					PY_IMG_UTIL_TRACE_SCOPE("copy", trace::dtype_name<T>(), shape, num_channels * width * height * sizeof(T));
+					py::gil_scoped_release release;
+					if (out_layout == layout::planar)
+					{
+						// Parallelize over all rows of all channels so that few-channel images still scale
+						const size_t grain = detail::parallel_grain_size(width * sizeof(T));
+						detail::parallel_for(num_channels * height, grain, [&](size_t begin, size_t end)
+							{
+								for (size_t row = begin; row < end; ++row)
+								{
+									const size_t channel = row / height;
+									const size_t y = row % height;
+									std::memcpy(out_ptr + row * width, channels[channel].data() + y * width, width * sizeof(T));
+								}
+							});
+					}
+					else
+					{
+						const size_t grain = detail::parallel_grain_size(width * num_channels * sizeof(T));
+						detail::parallel_for(height, grain, [&](size_t begin, size_t end)
+							{
+								for (size_t y = begin; y < end; ++y)
+								{
+									T* out_row = out_ptr + y * width * num_channels;
+									// Write each channel as a strided pass over the row, the row stays in cache 
+									// across all channels
+									for (size_t c = 0; c < num_channels; ++c)
+									{
+										const T* in_row = channels[c].data() + y * width;
+										for (size_t x = 0; x < width; ++x)
+										{
+											out_row[x * num_channels + c] = in_row[x];
+										}
+									}
+								}
+							});
+					}
+				}
+				return out;
 			}
 
 		} // to_py
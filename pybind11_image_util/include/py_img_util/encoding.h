@@ -0,0 +1,277 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <bit>
+#include <array>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+
+#include "macros.h"
+#include "parallel.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	/// Image encoded row by row into a byte stream, e.g. by PackBits RLE or delta prediction. Each row can be
+	/// decoded independently, row(y) returns its bytes.
+	struct encoded_image
+	{
+		/// The encoded rows, back to back
+		std::vector<uint8_t> data;
+		/// Offset of each row into data followed by data.size(), i.e. height + 1 entries
+		std::vector<size_t> row_offsets;
+		size_t width = 0;
+		size_t height = 0;
+
+		std::span<const uint8_t> row(size_t y) const
+		{
+			assert(y + 1 < row_offsets.size());
+			return std::span<const uint8_t>(data).subspan(row_offsets[y], row_offsets[y + 1] - row_offsets[y]);
+		}
+
+		/// The encoded size of the given row in bytes
+		size_t row_size(size_t y) const { return row_offsets[y + 1] - row_offsets[y]; }
+	};
+
+
+	/// Whether samples of type T can be delta encoded, i.e. integers other than bool
+	template <typename T>
+	inline constexpr bool is_delta_encodable_v = std::is_integral_v<T> && !std::is_same_v<T, bool>;
+
+
+	namespace detail
+	{
+
+		/// Store the value at dst in big-endian byte order which is what PSD/TIFF style encoders expect
+		template <typename T>
+		void store_big_endian(T value, uint8_t* dst) noexcept
+		{
+			auto bytes = std::bit_cast<std::array<uint8_t, sizeof(T)>>(value);
+			if constexpr (std::endian::native == std::endian::little)
+			{
+				std::reverse(bytes.begin(), bytes.end());
+			}
+			std::memcpy(dst, bytes.data(), sizeof(T));
+		}
+
+		/// Worst case size of a PackBits encoded buffer of `size` bytes, one header byte per 128 literals
+		inline constexpr size_t packbits_max_size(size_t size) noexcept
+		{
+			return size + (size + 127) / 128;
+		}
+
+		/// Encode `src` using PackBits RLE into `dst` which must hold at least packbits_max_size(src.size()) bytes.
+		/// Runs of 3 or more identical bytes are stored as a repeat packet (header 257 - n), everything else as
+		/// literal packets (header n - 1), each packet covering at most 128 bytes.
+		///
+		/// \return The number of bytes written
+		inline size_t packbits_encode(std::span<const uint8_t> src, uint8_t* dst) noexcept
+		{
+			const size_t size = src.size();
+			size_t in = 0;
+			size_t out = 0;
+			size_t literal_start = 0;
+
+			auto flush_literals = [&](size_t end)
+				{
+					while (literal_start < end)
+					{
+						const size_t count = std::min<size_t>(128, end - literal_start);
+						dst[out++] = static_cast<uint8_t>(count - 1);
+						std::memcpy(dst + out, src.data() + literal_start, count);
+						out += count;
+						literal_start += count;
+					}
+				};
+
+			while (in < size)
+			{
+				size_t run = 1;
+				while (in + run < size && run < 128 && src[in + run] == src[in])
+				{
+					++run;
+				}
+				if (run >= 3)
+				{
+					flush_literals(in);
+					dst[out++] = static_cast<uint8_t>(257 - run);
+					dst[out++] = src[in];
+					in += run;
+					literal_start = in;
+				}
+				else
+				{
+					in += run;
+				}
+			}
+			flush_literals(size);
+			return out;
+		}
+
+		/// Decode a PackBits encoded buffer into `dst` which must hold `dst_size` bytes.
+		///
+		/// \return false if the input is malformed or does not decode to exactly dst_size bytes
+		inline bool packbits_decode(std::span<const uint8_t> src, uint8_t* dst, size_t dst_size) noexcept
+		{
+			size_t in = 0;
+			size_t out = 0;
+			while (in < src.size())
+			{
+				const auto header = static_cast<int8_t>(src[in++]);
+				if (header >= 0)
+				{
+					const size_t count = static_cast<size_t>(header) + 1;
+					if (in + count > src.size() || out + count > dst_size)
+					{
+						return false;
+					}
+					std::memcpy(dst + out, src.data() + in, count);
+					in += count;
+					out += count;
+				}
+				else if (header != -128)
+				{
+					const size_t count = static_cast<size_t>(1 - header);
+					if (in >= src.size() || out + count > dst_size)
+					{
+						return false;
+					}
+					std::memset(dst + out, src[in++], count);
+					out += count;
+				}
+			}
+			return out == dst_size;
+		}
+
+		/// Encode every row of the row-major image with PackBits into one exactly sized buffer per band of
+		/// parallel_grain_size() rows, samples wider than a byte are encoded in big-endian byte order. Each parallel
+		/// chunk encodes its bands into a single worst-case sized scratch buffer which is reused across the bands,
+		/// so only the compacted bands and one scratch buffer per chunk are alive at once rather than a worst-case
+		/// buffer per band. The encoded size of row y is written to row_sizes[y + 1] which must hold height + 1
+		/// elements. Does not call into python.
+		template <typename T>
+		std::vector<std::vector<uint8_t>> packbits_encode_bands(const T* src, size_t width, size_t height, std::span<size_t> row_sizes)
+		{
+			const size_t row_bytes = width * sizeof(T);
+			const size_t grain = detail::parallel_grain_size(row_bytes);
+			const size_t num_bands = height == 0 ? 0 : (height + grain - 1) / grain;
+
+			std::vector<std::vector<uint8_t>> bands(num_bands);
+			detail::parallel_for(num_bands, 1, [&](size_t band_begin, size_t band_end)
+				{
+					std::vector<uint8_t> row_scratch(sizeof(T) == 1 ? 0 : row_bytes);
+					std::vector<uint8_t> band_scratch(packbits_max_size(row_bytes) * std::min(grain, height));
+					for (size_t band = band_begin; band < band_end; ++band)
+					{
+						const size_t y_begin = band * grain;
+						const size_t y_end = std::min(height, y_begin + grain);
+
+						size_t size = 0;
+						for (size_t y = y_begin; y < y_end; ++y)
+						{
+							const T* row = src + y * width;
+							std::span<const uint8_t> row_bytes_span;
+							if constexpr (sizeof(T) == 1)
+							{
+								row_bytes_span = std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(row), row_bytes);
+							}
+							else
+							{
+								for (size_t x = 0; x < width; ++x)
+								{
+									detail::store_big_endian(row[x], row_scratch.data() + x * sizeof(T));
+								}
+								row_bytes_span = row_scratch;
+							}
+							const size_t row_size = packbits_encode(row_bytes_span, band_scratch.data() + size);
+							size += row_size;
+							row_sizes[y + 1] = row_size;
+						}
+						bands[band].assign(band_scratch.begin(), band_scratch.begin() + size);
+					}
+				});
+			return bands;
+		}
+
+		/// Encode every row of the row-major image with PackBits, samples wider than a byte are encoded in
+		/// big-endian byte order. Bands of rows are encoded in parallel (see packbits_encode_bands()) and then
+		/// gathered into the output. Does not call into python.
+		template <typename T>
+		encoded_image packbits_encode_image(const T* src, size_t width, size_t height)
+		{
+			const size_t grain = detail::parallel_grain_size(width * sizeof(T));
+
+			encoded_image out;
+			out.width = width;
+			out.height = height;
+			out.row_offsets.resize(height + 1, 0);
+			const auto bands = packbits_encode_bands(src, width, height, std::span<size_t>(out.row_offsets));
+
+			// Prefix sum over the row sizes gives the final row offsets
+			for (size_t y = 0; y < height; ++y)
+			{
+				out.row_offsets[y + 1] += out.row_offsets[y];
+			}
+			out.data.resize(out.row_offsets[height]);
+			detail::parallel_for(bands.size(), 1, [&](size_t band_begin, size_t band_end)
+				{
+					for (size_t band = band_begin; band < band_end; ++band)
+					{
+						std::memcpy(out.data.data() + out.row_offsets[band * grain], bands[band].data(), bands[band].size());
+					}
+				});
+			return out;
+		}
+
+		/// Delta-predict every row of the row-major image, i.e. replace each sample by its (wrapping) difference
+		/// to its left neighbour, and store the result in big-endian byte order. This is the prediction applied
+		/// before ZIP compression in PSD and TIFF files. As the output size is known up front rows are written
+		/// straight into the output in parallel. Does not call into python.
+		template <typename T>
+			requires is_delta_encodable_v<T>
+		encoded_image delta_encode_image(const T* src, size_t width, size_t height)
+		{
+			using unsigned_type = std::make_unsigned_t<T>;
+			const size_t row_bytes = width * sizeof(T);
+
+			encoded_image out;
+			out.width = width;
+			out.height = height;
+			out.data.resize(row_bytes * height);
+			out.row_offsets.resize(height + 1);
+			for (size_t y = 0; y <= height; ++y)
+			{
+				out.row_offsets[y] = y * row_bytes;
+			}
+
+			uint8_t* dst = out.data.data();
+			detail::parallel_for(height, detail::parallel_grain_size(row_bytes), [&](size_t begin, size_t end)
+				{
+					for (size_t y = begin; y < end; ++y)
+					{
+						const T* row = src + y * width;
+						uint8_t* dst_row = dst + y * row_bytes;
+						unsigned_type previous = 0;
+						for (size_t x = 0; x < width; ++x)
+						{
+							const auto value = static_cast<unsigned_type>(row[x]);
+							detail::store_big_endian(static_cast<unsigned_type>(value - previous), dst_row + x * sizeof(T));
+							previous = value;
+						}
+					}
+				});
+			return out;
+		}
+
+	} // detail
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,288 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	/// Non-owning reference to a callable with the signature void(size_t chunk) which is passed to
+	/// executor::bulk_execute. It is only valid for the duration of that call.
+	class chunk_function
+	{
+	public:
+		template <typename Fn>
+			requires (!std::is_same_v<std::remove_cvref_t<Fn>, chunk_function>)
+		chunk_function(Fn& fn) noexcept
+			: m_Object(const_cast<void*>(static_cast<const void*>(std::addressof(fn)))),
+			m_Call([](void* object, size_t chunk) { (*static_cast<Fn*>(object))(chunk); }) {}
+
+		void operator()(size_t chunk) const { m_Call(m_Object, chunk); }
+
+	private:
+		void* m_Object = nullptr;
+		void(*m_Call)(void*, size_t) = nullptr;
+	};
+
+
+	/// Interface through which all parallel conversion work of the library is dispatched. Implement this to run
+	/// the work on an existing scheduler (a work-stealing pool, TBB etc.) instead of the built-in thread pool.
+	class executor
+	{
+	public:
+		virtual ~executor() = default;
+
+		/// Submit `num_chunks` chunks and wait for them to complete, i.e. invoke fn(chunk) exactly once for each
+		/// chunk in [0, num_chunks), possibly concurrently, and only return once all invocations have returned.
+		/// The calling thread may (and ideally should) process chunks itself. fn never throws and never calls into
+		/// python. bulk_execute may be called concurrently from several threads and from within a chunk.
+		virtual void bulk_execute(size_t num_chunks, chunk_function fn) = 0;
+
+		/// The number of chunks that can usefully run at the same time, the library never splits work into more
+		/// chunks than this.
+		virtual size_t concurrency() const noexcept = 0;
+	};
+
+
+	/// Executor running every chunk serially on the calling thread, disables all parallelism of the library
+	class inline_executor final : public executor
+	{
+	public:
+		void bulk_execute(size_t num_chunks, chunk_function fn) override
+		{
+			for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+			{
+				fn(chunk);
+			}
+		}
+
+		size_t concurrency() const noexcept override { return 1; }
+	};
+
+
+	/// Executor forwarding to a callable with the signature void(size_t num_chunks, chunk_function fn), the
+	/// simplest way to hook up an existing scheduler.
+	///
+	/// \code{.cpp}
+	/// auto tbb_executor = py_img_util::callback_executor([](size_t num_chunks, py_img_util::chunk_function fn)
+	///		{
+	///			tbb::parallel_for(size_t{ 0 }, num_chunks, [&](size_t chunk) { fn(chunk); });
+	///		}, tbb::this_task_arena::max_concurrency());
+	/// \endcode
+	template <typename Fn>
+	class callback_executor final : public executor
+	{
+	public:
+		callback_executor(Fn fn, size_t concurrency)
+			: m_Fn(std::move(fn)), m_Concurrency(std::max<size_t>(1, concurrency)) {}
+
+		void bulk_execute(size_t num_chunks, chunk_function fn) override { m_Fn(num_chunks, fn); }
+
+		size_t concurrency() const noexcept override { return m_Concurrency; }
+
+	private:
+		Fn m_Fn;
+		size_t m_Concurrency = 1;
+	};
+
+
+	/// Built-in pool of persistent worker threads, this is the default executor. Jobs are served in submission
+	/// order and the submitting thread always works on its own job as well, so nested bulk_execute calls from
+	/// within a chunk cannot deadlock.
+	class thread_pool_executor final : public executor
+	{
+	public:
+		/// Start a pool of `concurrency - 1` workers, the calling thread of bulk_execute making up the last one.
+		explicit thread_pool_executor(size_t concurrency = std::thread::hardware_concurrency())
+			: m_Concurrency(std::max<size_t>(1, concurrency))
+		{
+			m_Workers.reserve(m_Concurrency - 1);
+			for (size_t i = 1; i < m_Concurrency; ++i)
+			{
+				m_Workers.emplace_back([this]() { worker_loop(); });
+			}
+		}
+
+		thread_pool_executor(const thread_pool_executor&) = delete;
+		thread_pool_executor& operator=(const thread_pool_executor&) = delete;
+
+		~thread_pool_executor() override
+		{
+			{
+				std::lock_guard lock(m_Mutex);
+				m_Stop = true;
+			}
+			m_Condition.notify_all();
+			for (auto& worker : m_Workers)
+			{
+				worker.join();
+			}
+		}
+
+		void bulk_execute(size_t num_chunks, chunk_function fn) override
+		{
+			if (num_chunks == 0)
+			{
+				return;
+			}
+			auto job = std::make_shared<job_type>(fn, num_chunks);
+			if (num_chunks > 1 && !m_Workers.empty())
+			{
+				{
+					std::lock_guard lock(m_Mutex);
+					m_Jobs.push_back(job);
+				}
+				m_Condition.notify_all();
+			}
+
+			run_chunks(*job);
+			std::unique_lock lock(job->mutex);
+			job->finished.wait(lock, [&]() { return job->completed.load(std::memory_order_acquire) == job->count; });
+		}
+
+		size_t concurrency() const noexcept override { return m_Concurrency; }
+
+	private:
+		struct job_type
+		{
+			job_type(chunk_function fn_, size_t count_) : fn(fn_), count(count_) {}
+
+			chunk_function fn;
+			size_t count = 0;
+			std::atomic<size_t> next = 0;
+			std::atomic<size_t> completed = 0;
+			std::mutex mutex;
+			std::condition_variable finished;
+		};
+
+		size_t m_Concurrency = 1;
+		std::vector<std::thread> m_Workers;
+		std::deque<std::shared_ptr<job_type>> m_Jobs;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stop = false;
+
+		/// Claim and run chunks of the job until none are left
+		static void run_chunks(job_type& job)
+		{
+			for (size_t chunk = job.next.fetch_add(1, std::memory_order_relaxed); chunk < job.count;
+				chunk = job.next.fetch_add(1, std::memory_order_relaxed))
+			{
+				job.fn(chunk);
+				if (job.completed.fetch_add(1, std::memory_order_acq_rel) + 1 == job.count)
+				{
+					// Take the lock so the notification cannot slip in between the waiters' check and wait
+					std::lock_guard lock(job.mutex);
+					job.finished.notify_all();
+				}
+			}
+		}
+
+		void worker_loop()
+		{
+			while (true)
+			{
+				std::shared_ptr<job_type> job;
+				{
+					std::unique_lock lock(m_Mutex);
+					m_Condition.wait(lock, [&]() { return m_Stop || !m_Jobs.empty(); });
+					if (m_Stop)
+					{
+						return;
+					}
+					job = m_Jobs.front();
+					// Once all chunks are claimed the job no longer needs to be handed out
+					if (job->next.load(std::memory_order_relaxed) >= job->count)
+					{
+						m_Jobs.pop_front();
+						continue;
+					}
+				}
+				run_chunks(*job);
+			}
+		}
+	};
+
+
+	namespace detail
+	{
+		inline std::atomic<executor*>& global_executor_storage()
+		{
+			static std::atomic<executor*> instance = nullptr;
+			return instance;
+		}
+
+		/// The executor overriding the global one on this thread, see scoped_executor
+		inline thread_local executor* current_executor_override = nullptr;
+	} // detail
+
+
+	/// The built-in thread pool sized to the hardware concurrency, created on first use
+	inline executor& builtin_executor()
+	{
+		static thread_pool_executor instance;
+		return instance;
+	}
+
+	/// Replace the executor used for all parallel work of the library, pass nullptr to restore the built-in pool.
+	/// The executor is not owned and must outlive all conversions using it.
+	inline void set_default_executor(executor* exec) noexcept
+	{
+		detail::global_executor_storage().store(exec, std::memory_order_release);
+	}
+
+	/// The executor parallel work on the calling thread is dispatched through: the innermost scoped_executor if
+	/// any, otherwise the one passed to set_default_executor, otherwise the built-in pool.
+	inline executor& current_executor()
+	{
+		if (detail::current_executor_override)
+		{
+			return *detail::current_executor_override;
+		}
+		if (executor* global = detail::global_executor_storage().load(std::memory_order_acquire))
+		{
+			return *global;
+		}
+		return builtin_executor();
+	}
+
+
+	/// RAII guard dispatching all parallel work issued from the current thread through the given executor for as
+	/// long as it is alive, e.g. to run a single conversion serially or on a specific scheduler.
+	///
+	/// \code{.cpp}
+	/// py_img_util::inline_executor serial;
+	/// py_img_util::scoped_executor guard(serial);
+	/// auto vec = py_img_util::from_py_array(py_img_util::tag::vector{}, arr, width, height);
+	/// \endcode
+	class scoped_executor
+	{
+	public:
+		explicit scoped_executor(executor& exec) noexcept
+			: m_Previous(std::exchange(detail::current_executor_override, &exec)) {}
+
+		scoped_executor(const scoped_executor&) = delete;
+		scoped_executor& operator=(const scoped_executor&) = delete;
+
+		~scoped_executor() { detail::current_executor_override = m_Previous; }
+
+	private:
+		executor* m_Previous = nullptr;
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,250 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <span>
+#include <array>
+#include <format>
+#include <optional>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <cassert>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "macros.h"
+#include "validation.h"
+#include "detail.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	/// Bounded single-producer/single-consumer channel of preallocated image slots for handing frames from a C++
+	/// thread to python without allocating pixel storage in steady state.
+	///
+	/// The producer writes into a free slot without holding the GIL and publishes it, the consumer (holding the GIL)
+	/// receives the slot as a numpy array of shape [height, width] referencing the slots' memory. The slot is
+	/// recycled once the last python reference to that array dies. Slots are handed out and reused in order, so a
+	/// consumer holding on to one frame will eventually stall the producer once it wraps around.
+	///
+	/// All slots are owned by a state which outlives the channel for as long as python references any of its frames,
+	/// the channel may therefore be destroyed while python still holds on to them. The channel is move-only.
+	///
+	/// \code{.cpp}
+	/// py_img_util::frame_channel<float> channel(4, width, height);
+	/// // Producer thread, no GIL
+	/// channel.try_push(frame);
+	/// // Consumer, e.g. a bound method called from python
+	/// std::optional<py::array_t<float>> arr = channel.try_pop();
+	/// \endcode
+	///
+	/// \tparam T The element type
+	template <typename T>
+	class frame_channel
+	{
+	public:
+		/// Construct the channel, allocating `capacity` frames of width * height elements up front
+		///
+		/// \throws py::value_error if capacity is zero
+		frame_channel(size_t capacity, size_t width, size_t height)
+		{
+			if (capacity == 0)
+			{
+				throw py::value_error("Unable to construct a frame_channel with a capacity of zero");
+			}
+			m_State = new state(capacity, width, height);
+		}
+
+		frame_channel(const frame_channel&) = delete;
+		frame_channel& operator=(const frame_channel&) = delete;
+
+		frame_channel(frame_channel&& other) noexcept : m_State(std::exchange(other.m_State, nullptr)) {}
+
+		frame_channel& operator=(frame_channel&& other) noexcept
+		{
+			if (this != &other)
+			{
+				close();
+				m_State = std::exchange(other.m_State, nullptr);
+			}
+			return *this;
+		}
+
+		~frame_channel() { close(); }
+
+		/// The number of slots in the channel
+		size_t capacity() const noexcept { return m_State->slots.size(); }
+		size_t width() const noexcept { return m_State->width; }
+		size_t height() const noexcept { return m_State->height; }
+
+		// Producer interface, must only be called from a single thread. Does not call into python.
+		// ---------------------------------------------------------------------------------------------------------------------
+
+		/// Acquire the next slot for writing. Returns an empty span if the channel is full, i.e. the next slot
+		/// has not been consumed and released yet. Calling this again before commit() returns the same slot.
+		std::span<T> try_acquire() noexcept
+		{
+			if (!next_slot_free())
+			{
+				return {};
+			}
+			return m_State->frame(m_State->write_index % capacity());
+		}
+
+		/// Publish the slot previously returned by try_acquire() to the consumer
+		void commit() noexcept
+		{
+			auto& slot = m_State->slot_at(m_State->write_index);
+			assert(slot.status.load(std::memory_order_relaxed) == slot_status::free && "commit() called without a successful try_acquire()");
+			slot.status.store(slot_status::ready, std::memory_order_release);
+			++m_State->write_index;
+		}
+
+		/// Copy the frame into the next slot and publish it. Returns false if the channel is full.
+		///
+		/// \throws py::value_error if the frame does not hold width * height elements
+		bool try_push(std::span<const T> frame)
+		{
+			detail::check_cpp_span_matches_shape(frame, std::vector<size_t>{ height(), width() });
+			if (!next_slot_free())
+			{
+				return false;
+			}
+			std::memcpy(try_acquire().data(), frame.data(), frame.size() * sizeof(T));
+			commit();
+			return true;
+		}
+
+		// Consumer interface, must only be called from a single thread holding the GIL.
+		// ---------------------------------------------------------------------------------------------------------------------
+
+		/// Receive the next published frame as a numpy array referencing the slots' memory, or std::nullopt if no
+		/// frame is ready. The slot is returned to the producer once the array is garbage collected.
+		std::optional<py::array_t<T>> try_pop()
+		{
+			const size_t index = m_State->read_index;
+			auto& slot = m_State->slot_at(index);
+			if (slot.status.load(std::memory_order_acquire) != slot_status::ready)
+			{
+				return std::nullopt;
+			}
+			slot.status.store(slot_status::in_use, std::memory_order_relaxed);
+			++m_State->read_index;
+
+			// Only the pixel storage is recycled, every frame still creates a capsule and an ndarray object
+			return detail::to_py::from_borrowed(m_State->frame(index % capacity()), { height(), width() }, &slot, &release_slot, policy::unchecked{});
+		}
+
+	private:
+
+		enum class slot_status : uint8_t
+		{
+			free,
+			ready,
+			in_use,
+			/// Still referenced by python after the channel was destroyed
+			orphaned
+		};
+
+		struct state;
+
+		/// Each slots' status lives on its own cache line so the producer and consumer don't contend on neighbours
+		struct alignas(64) slot
+		{
+			std::atomic<slot_status> status = slot_status::free;
+			state* owner = nullptr;
+		};
+
+		struct state
+		{
+			state(size_t capacity, size_t width_, size_t height_)
+				: slots(capacity), storage(capacity * width_ * height_), width(width_), height(height_)
+			{
+				for (auto& slot : slots)
+				{
+					slot.owner = this;
+				}
+			}
+
+			std::vector<slot> slots;
+			std::vector<T> storage;
+			size_t width = 0;
+			size_t height = 0;
+			/// The number of orphaned slots that were not yet released by python, the state is deleted once the 
+			/// channel is destroyed and this reaches zero. May temporarily drop below zero while the channel is being
+			/// destroyed.
+			std::atomic<std::ptrdiff_t> orphans = 0;
+
+			// Monotonic counters, each only touched by its own side
+			alignas(64) size_t write_index = 0;
+			alignas(64) size_t read_index = 0;
+
+			slot& slot_at(size_t index) noexcept { return slots[index % slots.size()]; }
+
+			std::span<T> frame(size_t slot_index) noexcept
+			{
+				const size_t frame_size = width * height;
+				return std::span<T>(storage).subspan(slot_index * frame_size, frame_size);
+			}
+		};
+
+		state* m_State = nullptr;
+
+		/// Capsule destructor of each array handed out, returns the slot to the producer or, if the channel is gone,
+		/// deletes the state once the last orphaned slot was released
+		static void release_slot(void* ptr) noexcept
+		{
+			auto& slot = *static_cast<struct slot*>(ptr);
+			auto expected = slot_status::in_use;
+			if (slot.status.compare_exchange_strong(expected, slot_status::free, std::memory_order_release, std::memory_order_acquire))
+			{
+				return;
+			}
+			assert(expected == slot_status::orphaned);
+			state* owner = slot.owner;
+			if (owner->orphans.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				delete owner;
+			}
+		}
+
+		/// Orphan the slots python still references and delete the state if there are none
+		void close() noexcept
+		{
+			if (!m_State)
+			{
+				return;
+			}
+			std::ptrdiff_t orphaned = 0;
+			for (auto& slot : m_State->slots)
+			{
+				auto expected = slot_status::in_use;
+				if (slot.status.compare_exchange_strong(expected, slot_status::orphaned, std::memory_order_acq_rel))
+				{
+					++orphaned;
+				}
+			}
+			if (m_State->orphans.fetch_add(orphaned, std::memory_order_acq_rel) + orphaned == 0)
+			{
+				delete m_State;
+			}
+			m_State = nullptr;
+		}
+
+		bool next_slot_free() const noexcept
+		{
+			return m_State->slot_at(m_State->write_index).status.load(std::memory_order_acquire) == slot_status::free;
+		}
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -7,12 +7,27 @@
 #include <vector>
 #include <unordered_map>
 #include <span>
+#include <memory>
+#include <algorithm>
 
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 #include "macros.h"
+#include "policy.h"
+#include "allocator.h"
+#include "pitch.h"
 #include "detail.h"
+#include "cache.h"
+#include "typed_image.h"
+#include "planar_view.h"
+#include "sparse_image.h"
+#include "packed.h"
+#include "encoding.h"
+#include "quantize.h"
+#include "mip.h"
+#include "slab_arena.h"
+#include "lazy_array.h"
 
 
 namespace NAMESPACE_PY_IMAGE_UTIL
@@ -26,6 +41,17 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 		struct mapping {};
 		struct view {};
 		struct vector {};
+		struct huge_vector {};
+		struct cached {};
+		struct planar_view {};
+		struct sparse {};
+		template <size_t Bits>
+		struct packed {};
+		struct packbits {};
+		struct delta {};
+		struct lazy {};
+		template <layout Layout, size_t Channels>
+		struct typed {};
 	}
 
 
@@ -34,6 +60,9 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	/// \note Only use this function when the array data is guaranteed to outlive the view.
 	/// It is ideal for one-off computations, and the span should not be retained.
 	///
+	/// Non C-contiguous input is forcecast and `data` is rebound to the converted array so the result stays valid,
+	/// the handle must therefore not be shared with other threads during the call. See "Free-threaded python" in the README.
+	///
 	/// The input array must be one- or two-dimensional:
 	/// - If 1D: the size must be `expected_width * expected_height`
 	/// - If 2D: shape must be `[expected_height, expected_width]`
@@ -43,16 +72,18 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	/// \param data Python array to view; converted to C-contiguous layout if needed
 	/// \param expected_width Expected width (number of columns)
 	/// \param expected_height Expected height (number of rows)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
 	/// \return A const span over the flattened data
-	template <typename T>
+	template <typename T, validation_policy Policy = policy::checked>
 	const std::span<const T> from_py_array(
 		[[maybe_unused]] tag::view _,
 		py::array_t<T>& data,
 		size_t expected_width,
-		size_t expected_height
+		size_t expected_height,
+		Policy policy = {}
 	)
 	{
-		return detail::from_py::view(data, expected_width, expected_height);
+		return detail::from_py::view(data, expected_width, expected_height, policy);
 	}
 
 	/// \brief Generate a view over the py::array without copying.
@@ -86,6 +117,57 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	}
 
 
+	/// \brief Generate a per-channel view over a planar 3D py::array without copying.
+	///
+	/// \note Only use this function when the array data is guaranteed to outlive the view.
+	/// It is ideal for one-off computations, and the view should not be retained.
+	///
+	/// Non C-contiguous input is forcecast and `data` is rebound to the converted array so the result stays valid,
+	/// the handle must therefore not be shared with other threads during the call. See "Free-threaded python" in the README.
+	///
+	/// The input array must be three-dimensional with shape `[expected_channels, expected_height, expected_width]`
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for planar view dispatch
+	/// \param data Python array to view; converted to C-contiguous layout if needed
+	/// \param expected_channels Expected number of channels
+	/// \param expected_width Expected width (number of columns)
+	/// \param expected_height Expected height (number of rows)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return A lightweight range of const spans, one per channel
+	template <typename T, validation_policy Policy = policy::checked>
+	planar_view<T> from_py_array(
+		[[maybe_unused]] tag::planar_view _,
+		py::array_t<T>& data,
+		size_t expected_channels,
+		size_t expected_width,
+		size_t expected_height,
+		Policy policy = {}
+	)
+	{
+		return detail::from_py::planar(data, expected_channels, expected_width, expected_height, policy);
+	}
+
+	/// \brief Generate a per-channel view over a planar 3D py::array without copying.
+	///
+	/// \note Only use this function when the array data is guaranteed to outlive the view.
+	/// It is ideal for one-off computations, and the view should not be retained.
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for planar view dispatch
+	/// \param data Python array of shape `[channels, height, width]` to view; converted to C-contiguous layout if needed
+	/// \return A lightweight range of const spans, one per channel
+	template <typename T>
+	planar_view<T> from_py_array(
+		[[maybe_unused]] tag::planar_view _,
+		py::array_t<T>& data
+	)
+	{
+		auto shape = detail::shape_from_py_array(data, { 3 }, data.size());
+		return detail::from_py::planar(data, shape[0], shape[2], shape[1]);
+	}
+
+
 	/// \brief Convert a py::array into a std::vector with shape validation.
 	///
 	/// The input array must be one- or two-dimensional:
@@ -94,18 +176,125 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	///
 	/// \tparam T Type of array element
 	/// \param _ Tag for vector dispatch
-	/// \param data Input array to convert; will ensure C-contiguity
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
 	/// \param expected_width Width to validate (columns)
 	/// \param expected_height Height to validate (rows)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
 	/// \return Flattened std::vector<T> with row-major order
-	template <typename T>
+	template <typename T, validation_policy Policy = policy::checked>
 	std::vector<T> from_py_array(
 		[[maybe_unused]] tag::vector _,
-		py::array_t<T>& data,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		Policy policy = {})
+	{
+		return detail::from_py::vector(data, expected_width, expected_height, policy);
+	}
+
+	/// \brief Convert a py::array into an existing std::vector, reusing its storage.
+	///
+	/// Identical to the tag::vector overload returning a new vector except that the data is written into `out`.
+	/// It is resized to `expected_width * expected_height` elements which only allocates if its capacity is
+	/// insufficient, so converting same-sized arrays in a loop does not allocate once the vector has grown.
+	///
+	/// \code{.cpp}
+	/// std::vector<float> frame;
+	/// for (auto& arr : arrays)
+	/// {
+	///		py_img_util::from_py_array(py_img_util::tag::vector{}, arr, width, height, frame);
+	/// }
+	/// \endcode
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for vector dispatch
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \param out The vector to write the flattened, row-major data into
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	template <typename T, typename Alloc, validation_policy Policy = policy::checked>
+	void from_py_array(
+		[[maybe_unused]] tag::vector _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		std::vector<T, Alloc>& out,
+		Policy policy = {})
+	{
+		detail::from_py::vector_into(data, expected_width, expected_height, out, policy);
+	}
+
+	/// \brief Convert a py::array into caller provided storage.
+	///
+	/// Identical to the tag::vector overload returning a new vector except that the data is written into `out`
+	/// which must hold exactly `expected_width * expected_height` elements, e.g. a preallocated frame buffer.
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for vector dispatch
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \param out The storage to write the flattened, row-major data into
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \throws py::value_error if the size of `out` does not match
+	template <typename T, validation_policy Policy = policy::checked>
+	void from_py_array(
+		[[maybe_unused]] tag::vector _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		std::span<T> out,
+		Policy policy = {})
+	{
+		detail::from_py::span_into(data, expected_width, expected_height, out, policy);
+	}
+
+	/// \brief Validate a py::array now and defer its conversion until the data is first accessed.
+	///
+	/// The shape requirements are identical to the tag::vector overloads and are checked immediately. The copy
+	/// (or forcecast) only happens on the first call to lazy_array::data(), C-contiguous arrays are exposed
+	/// without copying. See lazy_array for the borrowing rules.
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for lazy dispatch
+	/// \param data Input array to convert; a reference is held by the returned handle
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \throws py::value_error if the shape does not match
+	/// \return The lazy handle to the array
+	template <typename T>
+	lazy_array<T> from_py_array(
+		[[maybe_unused]] tag::lazy _,
+		const py::array_t<T>& data,
 		size_t expected_width,
 		size_t expected_height)
 	{
-		return detail::from_py::vector(data, expected_width, expected_height);
+		return lazy_array<T>(data, expected_width, expected_height);
+	}
+
+	/// \brief Convert a py::array into a huge_vector with shape validation.
+	///
+	/// Identical to the tag::vector overload except that buffers above huge_page_threshold() are backed by 
+	/// transparent huge pages and filled by a parallel copy, cutting down the page faults on first touch for
+	/// very large images. See allocator.h
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for huge_vector dispatch
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return Flattened huge_vector<T> with row-major order
+	template <typename T, validation_policy Policy = policy::checked>
+	huge_vector<T> from_py_array(
+		[[maybe_unused]] tag::huge_vector _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		Policy policy = {})
+	{
+		return detail::from_py::huge(data, expected_width, expected_height, policy);
 	}
 
 	/// \brief Convert a py::array into a std::vector with shape validation.
@@ -114,12 +303,12 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	///
 	/// \tparam T Type of array element
 	/// \param _ Tag for vector dispatch
-	/// \param data Input array to convert; will ensure C-contiguity
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
 	/// \return Flattened std::vector<T> with row-major order
 	template <typename T>
 	std::vector<T> from_py_array(
 		[[maybe_unused]] tag::vector _,
-		py::array_t<T>& data
+		const py::array_t<T>& data
 	)
 	{
 		size_t expected_width = 0;
@@ -138,6 +327,211 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	}
 
 
+	/// \brief Non-throwing equivalent of from_py_array(tag::view{}, data, expected_width, expected_height).
+	///
+	/// Intended for hot loops probing many arrays where failures are expected. Instead of throwing a py::value_error
+	/// the validation error is returned, its message is only formatted when calling error().message().
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for view dispatch
+	/// \param data Python array to view; converted to C-contiguous layout if needed
+	/// \param expected_width Expected width (number of columns)
+	/// \param expected_height Expected height (number of rows)
+	/// \return Either a const span over the flattened data or the validation error
+	template <typename T>
+	validation_result<std::span<const T>> try_from_py_array(
+		[[maybe_unused]] tag::view _,
+		py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height
+	)
+	{
+		return detail::from_py::try_view(data, expected_width, expected_height);
+	}
+
+	/// \brief Non-throwing equivalent of from_py_array(tag::vector{}, data, expected_width, expected_height).
+	///
+	/// Intended for hot loops probing many arrays where failures are expected. Instead of throwing a py::value_error
+	/// the validation error is returned, its message is only formatted when calling error().message().
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for vector dispatch
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \return Either the flattened std::vector<T> with row-major order or the validation error
+	template <typename T>
+	validation_result<std::vector<T>> try_from_py_array(
+		[[maybe_unused]] tag::vector _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height
+	)
+	{
+		return detail::from_py::try_vector(data, expected_width, expected_height);
+	}
+
+
+	/// \brief Convert a py::array into a typed_image with compile-time layout and channel count.
+	///
+	/// The input array must match the images' shape exactly:
+	/// - If Channels == 1: shape must be `[expected_height, expected_width]`
+	/// - If planar: shape must be `[Channels, expected_height, expected_width]`
+	/// - If interleaved: shape must be `[expected_height, expected_width, Channels]`
+	///
+	/// \tparam Layout The channel layout of the image
+	/// \tparam Channels The number of channels of the image
+	/// \tparam T Type of array element
+	/// \param _ Tag for typed dispatch, carrying the layout and channel count
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \return The typed image holding a copy of the data
+	template <layout Layout, size_t Channels, typename T>
+	typed_image<T, Layout, Channels> from_py_array(
+		[[maybe_unused]] tag::typed<Layout, Channels> _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height
+	)
+	{
+		return detail::from_py::typed<typed_image<T, Layout, Channels>>(data, expected_width, expected_height);
+	}
+
+
+	/// \brief Convert a py::array into a sparse_image, storing tiles whose pixels are all identical as a single value.
+	///
+	/// Only tiles with differing pixels are copied so mostly empty or constant layers take up a fraction of the
+	/// memory of a dense copy. The shape requirements are identical to the tag::vector overloads.
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for sparse dispatch
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \param tile_size The size of the square tiles in pixels
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return The sparse tiled representation of the array
+	template <typename T, validation_policy Policy = policy::checked>
+	sparse_image<T> from_py_array(
+		[[maybe_unused]] tag::sparse _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		size_t tile_size = sparse_image<T>::default_tile_size,
+		Policy policy = {}
+	)
+	{
+		return detail::from_py::sparse(data, expected_width, expected_height, tile_size, policy);
+	}
+
+
+	/// \brief Pack a py::array into a packed_image with `Bits` bits per sample.
+	///
+	/// Accepts bool or integer arrays (e.g. a bool mask for 1-bit or uint16 sensor data for 10/12-bit) with the
+	/// same shape requirements as the tag::vector overloads. Rows are packed MSB-first and start on a byte boundary.
+	///
+	/// \tparam Bits Number of bits per sample, one of 1, 2, 4, 10 or 12
+	/// \tparam T Type of array element
+	/// \param _ Tag for packed dispatch
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \throws py::value_error if any value does not fit into `Bits` bits
+	/// \return The packed image
+	template <size_t Bits, typename T, validation_policy Policy = policy::checked>
+		requires std::is_integral_v<T>
+	packed_image<Bits> from_py_array(
+		[[maybe_unused]] tag::packed<Bits> _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		Policy policy = {}
+	)
+	{
+		return detail::from_py::packed<Bits>(data, expected_width, expected_height, policy);
+	}
+
+
+	/// \brief Encode a py::array row by row with PackBits RLE straight from the numpy buffer.
+	///
+	/// Equivalent to converting with tag::vector and encoding the result but skips the intermediate copy, the array
+	/// is read exactly once. Samples wider than a byte are encoded in big-endian byte order as expected by PSD and
+	/// TIFF. Same shape requirements as the tag::vector overloads.
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for packbits dispatch
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return The encoded rows along with their offsets
+	template <typename T, validation_policy Policy = policy::checked>
+	encoded_image from_py_array(
+		[[maybe_unused]] tag::packbits _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		Policy policy = {}
+	)
+	{
+		return detail::from_py::packbits(data, expected_width, expected_height, policy);
+	}
+
+
+	/// \brief Delta-predict a py::array row by row straight from the numpy buffer.
+	///
+	/// Each sample is replaced by its (wrapping) difference to its left neighbour and written in big-endian byte
+	/// order, i.e. the prediction PSD and TIFF apply before ZIP compression. The output has the same size as the 
+	/// input and is ready to be passed to a deflate compressor. Same shape requirements as the tag::vector overloads.
+	///
+	/// \tparam T Type of array element, must be integral and not bool
+	/// \param _ Tag for delta dispatch
+	/// \param data Input array to convert; never modified, forcecast into a temporary if not C-contiguous
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return The predicted rows along with their offsets
+	template <typename T, validation_policy Policy = policy::checked>
+		requires is_delta_encodable_v<T>
+	encoded_image from_py_array(
+		[[maybe_unused]] tag::delta _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		Policy policy = {}
+	)
+	{
+		return detail::from_py::delta(data, expected_width, expected_height, policy);
+	}
+
+
+	/// \brief Convert a py::array into a shared, immutable std::vector going through a conversion_cache.
+	///
+	/// Repeated conversions of the same (unmodified) python array return the same buffer without copying again.
+	/// The shape is validated on every call identical to the tag::vector overloads.
+	///
+	/// \tparam T Type of array element
+	/// \param _ Tag for cached dispatch
+	/// \param data Input array to convert; never modified
+	/// \param expected_width Width to validate (columns)
+	/// \param expected_height Height to validate (rows)
+	/// \param cache The cache to look up and store the converted buffer in
+	/// \return Shared, flattened std::vector<T> with row-major order
+	template <typename T>
+	std::shared_ptr<const std::vector<T>> from_py_array(
+		[[maybe_unused]] tag::cached _,
+		const py::array_t<T>& data,
+		size_t expected_width,
+		size_t expected_height,
+		conversion_cache& cache
+	)
+	{
+		return cache.get_or_convert(data, expected_width, expected_height);
+	}
+
+
 	/// \brief Convert a span to a 2D numpy array (py::array_t).
 	///
 	/// The output array will have shape `[height, width]`.
@@ -147,12 +541,13 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	/// \param data Input span to copy into numpy array
 	/// \param width Number of columns in the output
 	/// \param height Number of rows in the output
+	/// \param policy The validation policy, defaults to full validation. See policy.h
 	/// \return New py::array_t<T> with copied data
-	template <typename T>
-	py::array_t<T> to_py_array(const std::span<const T> data, size_t width, size_t height)
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(const std::span<const T> data, size_t width, size_t height, Policy policy = {})
 	{
 		std::vector<size_t> shape{ height, width };
-		return detail::to_py::from_view(data, shape);
+		return detail::to_py::from_view(data, shape, policy);
 	}
 
 
@@ -162,12 +557,13 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	/// \param data Vector containing the row-major data
 	/// \param width Number of columns
 	/// \param height Number of rows
+	/// \param policy The validation policy, defaults to full validation. See policy.h
 	/// \return py::array_t<T> sharing a copy of the vector data
-	template <typename T>
-	py::array_t<T> to_py_array(const std::vector<T>& data, size_t width, size_t height)
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(const std::vector<T>& data, size_t width, size_t height, Policy policy = {})
 	{
 		std::vector<size_t> shape{ height, width };
-		return detail::to_py::from_vector(data, shape);
+		return detail::to_py::from_vector(data, shape, policy);
 	}
 
 	/// \brief Move a std::vector<T> into a new py::array_t<T> with shape [height, width].
@@ -176,12 +572,377 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	/// \param data Vector (rvalue) to move into the array
 	/// \param width Number of columns
 	/// \param height Number of rows
+	/// \param policy The validation policy, defaults to full validation. See policy.h
 	/// \return py::array_t<T> taking ownership of the data
-	template <typename T>
-	py::array_t<T> to_py_array(std::vector<T>&& data, size_t width, size_t height)
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(std::vector<T>&& data, size_t width, size_t height, Policy policy = {})
+	{
+		std::vector<size_t> shape{ height, width };
+		return detail::to_py::from_vector(std::move(data), shape, policy);
+	}
+
+	/// \brief Move a huge_vector<T> into a new py::array_t<T> with shape [height, width].
+	///
+	/// \tparam T Data type
+	/// \param data Vector (rvalue) to move into the array
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return py::array_t<T> taking ownership of the data
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(huge_vector<T>&& data, size_t width, size_t height, Policy policy = {})
 	{
 		std::vector<size_t> shape{ height, width };
-		return detail::to_py::from_vector(std::move(data), shape);
+		return detail::to_py::from_vector(std::move(data), shape, policy);
+	}
+
+	/// \brief Expose a shared std::vector<T> as a read-only py::array_t with shape [height, width] without copying.
+	///
+	/// Python shares ownership of the buffer through the arrays' capsule so both sides can read the same
+	/// allocation. The returned array has `writeable=False`, use ensure_writeable() to get a private copy
+	/// only when a writable array is actually needed. The C++ side must not modify the buffer while python 
+	/// may still reference it.
+	///
+	/// \tparam T Data type
+	/// \param data Shared vector containing the row-major data
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return Read-only py::array_t<T> sharing the vectors' data
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(std::shared_ptr<const std::vector<T>> data, size_t width, size_t height, Policy policy = {})
+	{
+		std::vector<size_t> shape{ height, width };
+		return detail::to_py::from_shared(std::move(data), shape, policy);
+	}
+
+	/// \brief Expose a shared std::vector<T> as a read-only py::array_t with shape [height, width] without copying.
+	///
+	/// \see to_py_array(std::shared_ptr<const std::vector<T>>, size_t, size_t)
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(std::shared_ptr<std::vector<T>> data, size_t width, size_t height, Policy policy = {})
+	{
+		std::vector<size_t> shape{ height, width };
+		return detail::to_py::from_shared(std::shared_ptr<const std::vector<T>>(std::move(data)), shape, policy);
+	}
+
+	/// \brief Copy-on-write helper for arrays generated from shared buffers.
+	///
+	/// Returns the array itself if it is writable, otherwise a private, writable C-contiguous copy of it.
+	/// This way a copy is only materialized when python actually asks for a writable array.
+	///
+	/// \tparam T Data type
+	/// \param data The (possibly read-only) array
+	/// \return A writable array with the same contents
+	template <typename T>
+	py::array_t<T> ensure_writeable(const py::array_t<T>& data)
+	{
+		if (data.writeable())
+		{
+			return data;
+		}
+		return data.attr("copy")().template cast<py::array_t<T>>();
+	}
+
+
+	/// \brief Convert a buffer with padded rows to a compact 2D numpy array with shape [height, width].
+	///
+	/// The padding is stripped during the copy.
+	///
+	/// \tparam T Data type
+	/// \param data Input span holding `height` rows `pitch` bytes apart
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param pitch The distance between the start of two rows, must be a multiple of sizeof(T)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return New py::array_t<T> with copied, compacted data
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(const std::span<const T> data, size_t width, size_t height, row_pitch pitch, Policy policy = {})
+	{
+		return detail::to_py::from_pitched_view(data, width, height, pitch, policy);
+	}
+
+	/// \brief Convert a vector with padded rows to a compact 2D numpy array with shape [height, width].
+	///
+	/// The padding is stripped during the copy.
+	///
+	/// \tparam T Data type
+	/// \param data Vector holding `height` rows `pitch` bytes apart
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param pitch The distance between the start of two rows, must be a multiple of sizeof(T)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return New py::array_t<T> with copied, compacted data
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(const std::vector<T>& data, size_t width, size_t height, row_pitch pitch, Policy policy = {})
+	{
+		return detail::to_py::from_pitched_view(std::span<const T>(data), width, height, pitch, policy);
+	}
+
+	/// \brief Move a vector with padded rows into a new 2D py::array_t<T> with shape [height, width].
+	///
+	/// The data is not compacted, instead the padding is skipped through the numpy arrays' row stride. The 
+	/// resulting array is therefore not C-contiguous if the pitch is larger than the row.
+	///
+	/// \tparam T Data type
+	/// \param data Vector (rvalue) holding `height` rows `pitch` bytes apart
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param pitch The distance between the start of two rows, must be a multiple of sizeof(T)
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \return py::array_t<T> taking ownership of the data
+	template <typename T, validation_policy Policy = policy::checked>
+	py::array_t<T> to_py_array(std::vector<T>&& data, size_t width, size_t height, row_pitch pitch, Policy policy = {})
+	{
+		return detail::to_py::from_pitched_vector(std::move(data), width, height, pitch, policy);
+	}
+
+
+	/// \brief Quantize a floating point span into a uint8 or uint16 numpy array with shape [height, width].
+	///
+	/// Scaling, clamping, rounding and (optionally) dithering happen during the copy, writing straight into the
+	/// smaller numpy allocation. Equivalent to `np.clip(arr * scale + offset, 0, max).round().astype(Out)` without 
+	/// the float temporary.
+	///
+	/// \code{.cpp}
+	/// auto display = py_img_util::to_py_array<uint8_t>(std::span<const float>(linear), width, height, 
+	///		py_img_util::quantization{ .low = 0.0, .high = 1.0, .dither = py_img_util::dither_mode::ordered });
+	/// \endcode
+	///
+	/// \tparam Out The output type, uint8_t or uint16_t
+	/// \tparam T The input type, float or double
+	/// \param data Input span holding the row-major data
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param params The input range mapped onto the output range along with the dithering to apply
+	/// \param policy The validation policy, defaults to full validation. See policy.h
+	/// \throws py::value_error if the input range is empty or not finite
+	/// \return New py::array_t<Out> holding the quantized data
+	template <typename Out, typename T, validation_policy Policy = policy::checked>
+		requires is_quantizable_v<T, Out>
+	py::array_t<Out> to_py_array(const std::span<const T> data, size_t width, size_t height, quantization params, Policy policy = {})
+	{
+		return detail::to_py::quantized<Out>(data, width, height, params, policy);
+	}
+
+	/// \brief Quantize a floating point vector into a uint8 or uint16 numpy array with shape [height, width].
+	///
+	/// \see to_py_array(const std::span<const T>, size_t, size_t, quantization)
+	template <typename Out, typename T, validation_policy Policy = policy::checked>
+		requires is_quantizable_v<T, Out>
+	py::array_t<Out> to_py_array(const std::vector<T>& data, size_t width, size_t height, quantization params, Policy policy = {})
+	{
+		return detail::to_py::quantized<Out>(std::span<const T>(data), width, height, params, policy);
+	}
+
+
+	/// \brief Convert a typed_image to a numpy array copying the data.
+	///
+	/// The output shape is `[height, width]` for single channel images, `[Channels, height, width]` for
+	/// planar and `[height, width, Channels]` for interleaved images.
+	///
+	/// \param image The image to copy
+	/// \return New py::array_t<T> with copied data
+	template <typename T, layout Layout, size_t Channels>
+	py::array_t<T> to_py_array(const typed_image<T, Layout, Channels>& image)
+	{
+		return detail::to_py::from_typed(image);
+	}
+
+	/// \brief Move a typed_image into a numpy array without copying.
+	///
+	/// The output shape is `[height, width]` for single channel images, `[Channels, height, width]` for
+	/// planar and `[height, width, Channels]` for interleaved images.
+	///
+	/// \param image The image (rvalue) to move into the array
+	/// \return py::array_t<T> taking ownership of the data
+	template <typename T, layout Layout, size_t Channels>
+	py::array_t<T> to_py_array(typed_image<T, Layout, Channels>&& image)
+	{
+		return detail::to_py::from_typed(std::move(image));
+	}
+
+	/// \brief Expand a sparse_image into a dense numpy array with shape [height, width].
+	///
+	/// Uniform tiles are filled and dense tiles copied in parallel with the GIL released.
+	///
+	/// \param image The sparse image to expand
+	/// \return py::array_t<T> holding the dense image
+	template <typename T>
+	py::array_t<T> to_py_array(const sparse_image<T>& image)
+	{
+		return detail::to_py::from_sparse(image);
+	}
+
+	/// \brief Unpack a packed_image into a numpy array with shape [height, width].
+	///
+	/// The output dtype is uint8 for up to 8 bits per sample and uint16 otherwise.
+	///
+	/// \param image The packed image to unpack
+	/// \return py::array_t holding one sample per element
+	template <size_t Bits>
+	py::array_t<typename packed_image<Bits>::sample_type> to_py_array(const packed_image<Bits>& image)
+	{
+		return detail::to_py::from_packed(image);
+	}
+
+	/// \brief Convert an image to a numpy array along with a chain of mip levels in a single pass.
+	///
+	/// Returns the full resolution array of shape [height, width] followed by up to `levels` mip levels, each half 
+	/// the size of the previous one (rounded down, at least 1). The chain stops early once a 1x1 level is reached,
+	/// an empty image only yields the full resolution array. All arrays are views into one shared allocation which is freed once the last of them dies.
+	///
+	/// \tparam T Data type
+	/// \param data Span containing the row-major source data
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param levels Number of mip levels to generate in addition to the full resolution image
+	/// \param filter The filter used to reduce each level, defaults to a 2x2 box filter
+	/// \return The full resolution array followed by the mip levels
+	template <typename T>
+	std::vector<py::array_t<T>> to_py_mip_chain(std::span<const T> data, size_t width, size_t height, size_t levels, mip_filter filter = mip_filter::box)
+	{
+		return detail::to_py::mip_chain(data, width, height, levels, filter);
+	}
+
+	/// \brief Convert an image to a numpy array along with a chain of mip levels in a single pass.
+	///
+	/// \see to_py_mip_chain(std::span<const T>, size_t, size_t, size_t, mip_filter)
+	template <typename T>
+	std::vector<py::array_t<T>> to_py_mip_chain(const std::vector<T>& data, size_t width, size_t height, size_t levels, mip_filter filter = mip_filter::box)
+	{
+		return detail::to_py::mip_chain(std::span<const T>(data), width, height, levels, filter);
+	}
+
+	/// \brief Copy a C++ buffer into a rectangular region of an existing numpy array.
+	///
+	/// Equivalent to `target[y:y+height, x:x+width] = data` in python without the intermediate array. The target
+	/// must be a writable 2D [height, width] or 3D interleaved [height, width, channels] array in which case the 
+	/// buffer holds width * height * channels interleaved elements. The target is written in place and may be a 
+	/// non-contiguous view. Large regions are copied across rows in parallel with the GIL released.
+	///
+	/// \note Bind the target with `py::arg("target").noconvert()`, otherwise pybind11 silently converts an array
+	/// of a different dtype into a temporary which is then pasted into instead of the callers' array.
+	///
+	/// \tparam T Data type
+	/// \param target The array to paste into
+	/// \param data Span containing the row-major region data
+	/// \param x Column of the top left corner of the region in the target
+	/// \param y Row of the top left corner of the region in the target
+	/// \param width Number of columns of the region
+	/// \param height Number of rows of the region
+	/// \throws py::value_error if the region exceeds the target, the target is read-only or the buffer size does not match
+	template <typename T>
+	void paste_into(py::array_t<T>& target, std::span<const T> data, size_t x, size_t y, size_t width, size_t height)
+	{
+		detail::to_py::paste(target, data, x, y, width, height);
+	}
+
+	/// \brief Copy a C++ buffer into a rectangular region of an existing numpy array.
+	///
+	/// \see paste_into(py::array_t<T>&, std::span<const T>, size_t, size_t, size_t, size_t)
+	template <typename T>
+	void paste_into(py::array_t<T>& target, const std::vector<T>& data, size_t x, size_t y, size_t width, size_t height)
+	{
+		detail::to_py::paste(target, std::span<const T>(data), x, y, width, height);
+	}
+
+	/// \brief Stack a number of channels into a single 3D numpy array.
+	///
+	/// The output array has shape `[channels, height, width]` for layout::planar and `[height, width, channels]`
+	/// for layout::interleaved. It is allocated once and the channels are copied in parallel with the GIL released, 
+	/// avoiding a to_py_array call per channel followed by np.stack.
+	///
+	/// \tparam T Data type
+	/// \param channels Spans over the channels, each holding width * height elements in row-major order
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param out_layout The layout of the output array
+	/// \return New py::array_t<T> with copied data
+	template <typename T>
+	py::array_t<T> to_py_array(
+		std::span<const std::span<const T>> channels,
+		size_t width,
+		size_t height,
+		layout out_layout = layout::planar
+	)
+	{
+		return detail::to_py::from_channels(channels, width, height, out_layout);
+	}
+
+	/// \brief Stack a number of channels into a single 3D numpy array.
+	///
+	/// The output array has shape `[channels, height, width]` for layout::planar and `[height, width, channels]`
+	/// for layout::interleaved.
+	///
+	/// \tparam T Data type
+	/// \param channels The channels, each holding width * height elements in row-major order
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param out_layout The layout of the output array
+	/// \return New py::array_t<T> with copied data
+	template <typename T>
+	py::array_t<T> to_py_array(
+		const std::vector<std::vector<T>>& channels,
+		size_t width,
+		size_t height,
+		layout out_layout = layout::planar
+	)
+	{
+		std::vector<std::span<const T>> spans(channels.begin(), channels.end());
+		return detail::to_py::from_channels(std::span<const std::span<const T>>(spans), width, height, out_layout);
+	}
+
+	/// \brief Stack a number of channels into a single 3D numpy array.
+	///
+	/// Overload for temporaries so these do not bind to the flat std::vector<T>&& overload. The channels are 
+	/// still copied as each channel is its own allocation.
+	template <typename T>
+	py::array_t<T> to_py_array(
+		std::vector<std::vector<T>>&& channels,
+		size_t width,
+		size_t height,
+		layout out_layout = layout::planar
+	)
+	{
+		const auto& channels_ref = channels;
+		return to_py_array(channels_ref, width, height, out_layout);
+	}
+
+	/// \brief Stack a mapping of channel index to channel data into a single 3D numpy array.
+	///
+	/// The channels are stacked in ascending order of their index, e.g. for a mapping with the keys
+	/// { -1, 0, 1, 2 } the alpha channel (-1) ends up as the first channel.
+	///
+	/// \tparam T Data type
+	/// \param channels Mapping of channel index to the channel data, each holding width * height elements
+	/// \param width Number of columns
+	/// \param height Number of rows
+	/// \param out_layout The layout of the output array
+	/// \return New py::array_t<T> with copied data
+	template <typename T>
+	py::array_t<T> to_py_array(
+		const std::unordered_map<int, std::vector<T>>& channels,
+		size_t width,
+		size_t height,
+		layout out_layout = layout::planar
+	)
+	{
+		std::vector<int> keys;
+		keys.reserve(channels.size());
+		for (const auto& [key, _] : channels)
+		{
+			keys.push_back(key);
+		}
+		std::sort(keys.begin(), keys.end());
+
+		std::vector<std::span<const T>> spans;
+		spans.reserve(keys.size());
+		for (const auto key : keys)
+		{
+			spans.emplace_back(channels.at(key));
+		}
+		return detail::to_py::from_channels(std::span<const std::span<const T>>(spans), width, height, out_layout);
 	}
 
 } // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,151 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <utility>
+#include <optional>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "macros.h"
+#include "validation.h"
+#include "detail.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	/// Handle to a numpy array which validates its shape on construction but defers the conversion until the data
+	/// is first accessed. Intended for optional inputs (e.g. masks) that are often never read, shape errors still
+	/// surface at call time while the copy is only paid for when needed.
+	///
+	/// On first access a C-contiguous source is exposed directly without copying, any other source is converted
+	/// (forcecast or transposed, see from_py_array(tag::vector{}, ...)) into an internal buffer which is cached for
+	/// subsequent accesses. A default constructed lazy_array represents an absent input.
+	///
+	/// The handle keeps a reference to the source array so the data stays alive for as long as the handle does. As
+	/// with tag::view, the source must not be modified (or resized) from python while the handle is in use. The
+	/// first access may call into python and therefore requires the GIL, later accesses do not. A handle must not be
+	/// accessed from several threads until it is materialized.
+	///
+	/// \code{.cpp}
+	/// void apply(py::array_t<float> layer, std::optional<py::array_t<uint8_t>> mask)
+	/// {
+	///		auto lazy_mask = mask ? py_img_util::from_py_array(py_img_util::tag::lazy{}, *mask, width, height) : py_img_util::lazy_array<uint8_t>{};
+	///		if (!needs_mask(layer))
+	///		{
+	///			return; // the mask was validated but never copied
+	///		}
+	///		std::span<const uint8_t> mask_data = lazy_mask.data();
+	/// }
+	/// \endcode
+	///
+	/// \tparam T The element type
+	template <typename T>
+	class lazy_array
+	{
+	public:
+		lazy_array() = default;
+
+		/// Validate the shape of the array against the expected width and height without converting it.
+		///
+		/// \throws py::value_error if the number of dimensions or the shape does not match, or the array is null
+		lazy_array(py::array_t<T> data, size_t expected_width, size_t expected_height)
+			: m_Source(std::move(data)), m_Width(expected_width), m_Height(expected_height)
+		{
+			detail::from_py::validate_shape(*m_Source, m_Width, m_Height);
+			detail::check_not_null(*m_Source);
+		}
+
+		/// Whether the handle refers to an array
+		bool has_value() const noexcept { return m_Source.has_value(); }
+		explicit operator bool() const noexcept { return has_value(); }
+
+		size_t width() const noexcept { return m_Width; }
+		size_t height() const noexcept { return m_Height; }
+		size_t size() const noexcept { return m_Width * m_Height; }
+
+		/// Whether the data was already accessed, i.e. whether data() is free to call without the GIL
+		bool is_materialized() const noexcept { return m_Materialized; }
+
+		/// Whether the data is exposed directly from the numpy buffer rather than an internal copy. Only
+		/// meaningful once materialized.
+		bool is_zero_copy() const noexcept { return m_Materialized && m_Buffer.empty() && size() != 0; }
+
+		/// Access the flat, row-major data converting it on first access. Returns an empty span for an absent input.
+		std::span<const T> data()
+		{
+			if (!m_Materialized)
+			{
+				materialize();
+			}
+			return materialized_data();
+		}
+
+		/// Copy the data into a new vector, converting the source straight into it if it was not accessed yet
+		std::vector<T> to_vector()
+		{
+			if (!has_value())
+			{
+				return {};
+			}
+			if (!m_Materialized)
+			{
+				return detail::from_py::vector(*m_Source, m_Width, m_Height);
+			}
+			const std::span<const T> data = materialized_data();
+			return std::vector<T>(data.begin(), data.end());
+		}
+
+		/// Release the converted buffer, moving it out if it was copied. Leaves the handle empty.
+		std::vector<T> release() &&
+		{
+			std::vector<T> out = m_Materialized && !m_Buffer.empty() ? std::move(m_Buffer) : to_vector();
+			*this = lazy_array{};
+			return out;
+		}
+
+	private:
+		/// Empty for an absent input, this also means a default constructed handle does not require the interpreter
+		std::optional<py::array_t<T>> m_Source;
+		/// The converted data if the source could not be exposed directly. The span over it is rebuilt on every
+		/// access rather than cached so copies of a materialized handle never point into another handle's buffer.
+		std::vector<T> m_Buffer;
+		size_t m_Width = 0;
+		size_t m_Height = 0;
+		bool m_Materialized = false;
+
+		void materialize()
+		{
+			if (has_value())
+			{
+				if (!detail::is_c_style_contiguous(*m_Source))
+				{
+					m_Buffer = detail::from_py::vector(*m_Source, m_Width, m_Height);
+				}
+			}
+			m_Materialized = true;
+		}
+
+		std::span<const T> materialized_data() const
+		{
+			if (!has_value())
+			{
+				return {};
+			}
+			if (!m_Buffer.empty())
+			{
+				return m_Buffer;
+			}
+			return std::span<const T>(m_Source->data(), size());
+		}
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
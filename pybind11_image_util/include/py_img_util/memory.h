@@ -0,0 +1,244 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	/// Snapshot of the memory held by python objects whose buffers were handed over by this library
+	/// (e.g. via to_py_array(std::vector<T>&&, ...)).
+	struct memory_stats
+	{
+		/// Bytes currently kept alive by python objects
+		size_t live_bytes = 0;
+		/// Highest value live_bytes reached since tracking was enabled
+		size_t peak_bytes = 0;
+		/// Number of buffers currently kept alive by python objects
+		size_t live_allocations = 0;
+		/// Number of buffers handed over since tracking was enabled
+		size_t total_allocations = 0;
+	};
+
+
+	namespace detail
+	{
+
+		/// Lock-free counters for a single label (or the global total)
+		struct memory_counters
+		{
+			std::atomic<size_t> live_bytes = 0;
+			std::atomic<size_t> peak_bytes = 0;
+			std::atomic<size_t> live_allocations = 0;
+			std::atomic<size_t> total_allocations = 0;
+
+			void add(size_t bytes) noexcept
+			{
+				const size_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+				size_t peak = peak_bytes.load(std::memory_order_relaxed);
+				while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+				live_allocations.fetch_add(1, std::memory_order_relaxed);
+				total_allocations.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			void remove(size_t bytes) noexcept
+			{
+				live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+				live_allocations.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			memory_stats snapshot() const noexcept
+			{
+				return {
+					live_bytes.load(std::memory_order_relaxed),
+					peak_bytes.load(std::memory_order_relaxed),
+					live_allocations.load(std::memory_order_relaxed),
+					total_allocations.load(std::memory_order_relaxed)
+				};
+			}
+		};
+
+		/// Global state of the memory tracker, the label map is only touched when a buffer is handed over
+		/// under a label, releasing a buffer never takes the lock.
+		struct memory_registry
+		{
+			std::atomic<bool> enabled = false;
+			memory_counters total;
+			std::mutex mutex;
+			std::unordered_map<std::string, std::shared_ptr<memory_counters>> labels;
+
+			std::shared_ptr<memory_counters> counters_for(std::string_view label)
+			{
+				std::lock_guard lock(mutex);
+				auto& counters = labels[std::string(label)];
+				if (!counters)
+				{
+					counters = std::make_shared<memory_counters>();
+				}
+				return counters;
+			}
+		};
+
+		inline memory_registry& memory_registry_instance()
+		{
+			static memory_registry registry;
+			return registry;
+		}
+
+		/// The label applied to buffers handed over on this thread, see scoped_memory_label
+		inline thread_local std::string_view current_memory_label = {};
+
+		/// Accounts a single buffer for as long as it is alive, intended to be stored next to the buffer inside
+		/// the capsule owning it. When tracking is disabled this costs a single relaxed atomic load.
+		class memory_token
+		{
+		public:
+			memory_token() = default;
+
+			explicit memory_token(size_t bytes)
+			{
+				auto& registry = memory_registry_instance();
+				if (!registry.enabled.load(std::memory_order_relaxed))
+				{
+					return;
+				}
+				m_Bytes = bytes;
+				m_Tracked = true;
+				registry.total.add(bytes);
+				if (!current_memory_label.empty())
+				{
+					m_Label = registry.counters_for(current_memory_label);
+					m_Label->add(bytes);
+				}
+			}
+
+			memory_token(const memory_token&) = delete;
+			memory_token& operator=(const memory_token&) = delete;
+
+			memory_token(memory_token&& other) noexcept
+				: m_Bytes(other.m_Bytes), m_Tracked(std::exchange(other.m_Tracked, false)), m_Label(std::move(other.m_Label)) {}
+
+			memory_token& operator=(memory_token&& other) noexcept
+			{
+				if (this != &other)
+				{
+					release();
+					m_Bytes = other.m_Bytes;
+					m_Tracked = std::exchange(other.m_Tracked, false);
+					m_Label = std::move(other.m_Label);
+				}
+				return *this;
+			}
+
+			~memory_token() { release(); }
+
+		private:
+			size_t m_Bytes = 0;
+			bool m_Tracked = false;
+			std::shared_ptr<memory_counters> m_Label;
+
+			void release() noexcept
+			{
+				if (!m_Tracked)
+				{
+					return;
+				}
+				memory_registry_instance().total.remove(m_Bytes);
+				if (m_Label)
+				{
+					m_Label->remove(m_Bytes);
+					m_Label.reset();
+				}
+				m_Tracked = false;
+			}
+		};
+
+	} // detail
+
+
+	/// Enable or disable the accounting of buffers handed over to python. Disabled by default, buffers handed
+	/// over while tracking is disabled are never accounted, even once it gets enabled.
+	inline void set_memory_tracking(bool enabled)
+	{
+		detail::memory_registry_instance().enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	/// Whether buffers handed over to python are currently being accounted
+	inline bool memory_tracking_enabled()
+	{
+		return detail::memory_registry_instance().enabled.load(std::memory_order_relaxed);
+	}
+
+	/// The memory currently held by python objects across all labels
+	inline memory_stats memory_usage()
+	{
+		return detail::memory_registry_instance().total.snapshot();
+	}
+
+	/// The memory currently held by python objects for buffers handed over under the given label
+	inline memory_stats memory_usage(std::string_view label)
+	{
+		auto& registry = detail::memory_registry_instance();
+		std::lock_guard lock(registry.mutex);
+		auto it = registry.labels.find(std::string(label));
+		if (it == registry.labels.end())
+		{
+			return {};
+		}
+		return it->second->snapshot();
+	}
+
+	/// The memory usage of every label that was seen so far, sorted by label
+	inline std::vector<std::pair<std::string, memory_stats>> memory_usage_by_label()
+	{
+		auto& registry = detail::memory_registry_instance();
+		std::vector<std::pair<std::string, memory_stats>> out;
+		{
+			std::lock_guard lock(registry.mutex);
+			out.reserve(registry.labels.size());
+			for (const auto& [label, counters] : registry.labels)
+			{
+				out.emplace_back(label, counters->snapshot());
+			}
+		}
+		std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		return out;
+	}
+
+	/// Tag all buffers handed over to python on this thread with the given label while in scope. Labels nest,
+	/// the innermost label wins. The label must outlive the scope.
+	///
+	/// \code{.cpp}
+	/// py_img_util::scoped_memory_label label("layer_cache");
+	/// auto arr = py_img_util::to_py_array(std::move(vec), width, height);
+	/// \endcode
+	class scoped_memory_label
+	{
+	public:
+		explicit scoped_memory_label(std::string_view label) noexcept
+			: m_Previous(std::exchange(detail::current_memory_label, label)) {}
+
+		scoped_memory_label(const scoped_memory_label&) = delete;
+		scoped_memory_label& operator=(const scoped_memory_label&) = delete;
+
+		~scoped_memory_label() { detail::current_memory_label = m_Previous; }
+
+	private:
+		std::string_view m_Previous;
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,62 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <string>
+#include <optional>
+
+// Only this header pulls in the STL type casters, it is kept out of image.h on purpose as they change how every 
+// std::vector or std::map argument of the including module converts and conflict with PYBIND11_MAKE_OPAQUE
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "macros.h"
+#include "memory.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	namespace detail
+	{
+		inline py::dict memory_stats_to_dict(const memory_stats& stats)
+		{
+			py::dict out;
+			out["live_bytes"] = stats.live_bytes;
+			out["peak_bytes"] = stats.peak_bytes;
+			out["live_allocations"] = stats.live_allocations;
+			out["total_allocations"] = stats.total_allocations;
+			return out;
+		}
+	} // detail
+
+	/// Register the memory accounting functions on the given python module:
+	///
+	/// - `set_memory_tracking(enabled: bool)`
+	/// - `memory_tracking_enabled() -> bool`
+	/// - `memory_usage(label: str | None = None) -> dict`
+	/// - `memory_usage_by_label() -> dict[str, dict]`
+	inline void bind_memory_tracking(py::module_& m)
+	{
+		m.def("set_memory_tracking", &set_memory_tracking, py::arg("enabled"));
+		m.def("memory_tracking_enabled", &memory_tracking_enabled);
+		m.def("memory_usage", [](std::optional<std::string> label)
+			{
+				return detail::memory_stats_to_dict(label ? memory_usage(*label) : memory_usage());
+			}, py::arg("label") = py::none());
+		m.def("memory_usage_by_label", []()
+			{
+				py::dict out;
+				for (const auto& [label, stats] : memory_usage_by_label())
+				{
+					out[py::str(label)] = detail::memory_stats_to_dict(stats);
+				}
+				return out;
+			});
+	}
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
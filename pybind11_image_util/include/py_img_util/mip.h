@@ -0,0 +1,105 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	/// Filter used to reduce 2x2 pixels of a mip level into a single pixel of the next level
+	enum class mip_filter
+	{
+		/// Average of the 2x2 pixels, rounded to nearest for integer types
+		box,
+		/// The top-left pixel of the 2x2 block
+		nearest
+	};
+
+
+	namespace detail
+	{
+
+		/// Dimensions of a single mip level along with its offset into the shared storage
+		struct mip_level
+		{
+			size_t width = 0;
+			size_t height = 0;
+			size_t offset = 0;
+		};
+
+		/// Compute the dimensions of the full resolution image followed by up to `levels` mip levels. Each level
+		/// halves the previous one (rounding down, but at least 1) and the chain stops once a 1x1 level was reached.
+		/// An empty image (either dimension 0) has no mip levels. All levels are laid out back to back in a single buffer.
+		inline std::vector<mip_level> mip_chain_layout(size_t width, size_t height, size_t levels)
+		{
+			std::vector<mip_level> out;
+			out.push_back({ width, height, 0 });
+			size_t offset = width * height;
+			for (size_t i = 0; i < levels && width > 0 && height > 0 && (width > 1 || height > 1); ++i)
+			{
+				width = std::max<size_t>(1, width / 2);
+				height = std::max<size_t>(1, height / 2);
+				out.push_back({ width, height, offset });
+				offset += width * height;
+			}
+			return out;
+		}
+
+		/// Reduce two source rows of width `src_width` into a single row of `dst_width` pixels. The second row may
+		/// alias the first if the source only has a single row.
+		template <typename T>
+		void downsample_row(const T* row0, const T* row1, T* dst, size_t src_width, size_t dst_width, mip_filter filter) noexcept
+		{
+			if (filter == mip_filter::nearest)
+			{
+				for (size_t x = 0; x < dst_width; ++x)
+				{
+					dst[x] = row0[std::min(2 * x, src_width - 1)];
+				}
+				return;
+			}
+
+			// Accumulate in a wider type so integer sums can't overflow. Integer averages round half up via an arithmetic
+			// shift rather than a division, which would round negative sums towards zero
+			using acc_type = std::conditional_t<std::is_floating_point_v<T>, T, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+			const size_t paired = std::min(dst_width, src_width / 2);
+			for (size_t x = 0; x < paired; ++x)
+			{
+				const acc_type sum = static_cast<acc_type>(row0[2 * x]) + static_cast<acc_type>(row0[2 * x + 1])
+					+ static_cast<acc_type>(row1[2 * x]) + static_cast<acc_type>(row1[2 * x + 1]);
+				if constexpr (std::is_floating_point_v<T>)
+				{
+					dst[x] = static_cast<T>(sum * static_cast<acc_type>(0.25));
+				}
+				else
+				{
+					dst[x] = static_cast<T>((sum + 2) >> 2);
+				}
+			}
+			// A single column source is averaged vertically only
+			for (size_t x = paired; x < dst_width; ++x)
+			{
+				const acc_type sum = static_cast<acc_type>(row0[src_width - 1]) + static_cast<acc_type>(row1[src_width - 1]);
+				if constexpr (std::is_floating_point_v<T>)
+				{
+					dst[x] = static_cast<T>(sum * static_cast<acc_type>(0.5));
+				}
+				else
+				{
+					dst[x] = static_cast<T>((sum + 1) >> 1);
+				}
+			}
+		}
+
+	} // detail
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,203 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <format>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+#include <pybind11/pybind11.h>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	/// Whether the given number of bits per sample is supported by packed_image
+	template <size_t Bits>
+	inline constexpr bool is_supported_packed_bits_v = Bits == 1 || Bits == 2 || Bits == 4 || Bits == 10 || Bits == 12;
+
+	/// Single channel image with `Bits` bits per sample packed into a byte buffer.
+	///
+	/// Samples are stored as an MSB-first bit stream, i.e. the first sample of a row occupies the most significant
+	/// bits of the first byte, and every row starts on a byte boundary (unused bits at the end of a row are zero).
+	/// For 1-bit images this matches the output of `np.packbits(arr, axis=-1)`.
+	///
+	/// \tparam Bits The number of bits per sample, one of 1, 2, 4, 10 or 12
+	template <size_t Bits>
+	class packed_image
+	{
+		static_assert(is_supported_packed_bits_v<Bits>, "packed_image only supports 1, 2, 4, 10 or 12 bits per sample");
+
+	public:
+		static constexpr size_t bits = Bits;
+		/// The smallest unsigned type holding a single unpacked sample
+		using sample_type = std::conditional_t<(Bits <= 8), uint8_t, uint16_t>;
+		/// The largest value representable by a sample
+		static constexpr sample_type max_value = static_cast<sample_type>((1u << Bits) - 1);
+
+		/// Number of bytes taken up by a row of the given width
+		static constexpr size_t row_bytes_for(size_t width) noexcept { return (width * Bits + 7) / 8; }
+
+		packed_image() = default;
+
+		/// Construct a zero-initialized image of the given size
+		packed_image(size_t width, size_t height)
+			: m_Data(row_bytes_for(width) * height), m_Width(width), m_Height(height) {}
+
+		/// Construct an image from already packed data which must be of size row_bytes_for(width) * height
+		///
+		/// \throws py::value_error if the data size does not match
+		packed_image(std::vector<uint8_t> data, size_t width, size_t height)
+			: m_Data(std::move(data)), m_Width(width), m_Height(height)
+		{
+			if (m_Data.size() != row_bytes_for(width) * height)
+			{
+				throw py::value_error(
+					std::format(
+						"Invalid data size passed to packed_image<{}>, expected {:L} bytes but instead got {:L}",
+						Bits, row_bytes_for(width) * height, m_Data.size()
+					)
+				);
+			}
+		}
+
+		size_t width() const noexcept { return m_Width; }
+		size_t height() const noexcept { return m_Height; }
+		size_t row_bytes() const noexcept { return row_bytes_for(m_Width); }
+
+		std::span<uint8_t> data() noexcept { return m_Data; }
+		std::span<const uint8_t> data() const noexcept { return m_Data; }
+
+		std::span<uint8_t> row(size_t y) noexcept { return data().subspan(y * row_bytes(), row_bytes()); }
+		std::span<const uint8_t> row(size_t y) const noexcept { return data().subspan(y * row_bytes(), row_bytes()); }
+
+		/// Release the underlying storage, leaving the image empty
+		std::vector<uint8_t> release() &&
+		{
+			m_Width = 0;
+			m_Height = 0;
+			return std::move(m_Data);
+		}
+
+		/// The sample at the given coordinate
+		sample_type at(size_t x, size_t y) const
+		{
+			assert(x < m_Width && y < m_Height);
+			const uint8_t* row_ptr = m_Data.data() + y * row_bytes();
+			const size_t bit = x * Bits;
+			// A sample spans at most 3 bytes (12 bits starting at a bit offset of up to 7)
+			uint32_t window = 0;
+			for (size_t i = 0; i < 3; ++i)
+			{
+				const size_t byte = bit / 8 + i;
+				window = (window << 8) | (byte < row_bytes() ? row_ptr[byte] : 0u);
+			}
+			return static_cast<sample_type>((window >> (24 - Bits - bit % 8)) & max_value);
+		}
+
+	private:
+		std::vector<uint8_t> m_Data;
+		size_t m_Width = 0;
+		size_t m_Height = 0;
+	};
+
+
+	namespace detail
+	{
+
+		/// Number of samples making up a group which packs into a whole number of bytes, e.g. 4 samples of 10 bits
+		/// pack into 5 bytes. The pack and unpack kernels work on whole groups at a time.
+		template <size_t Bits>
+		inline constexpr size_t packed_group_samples = Bits == 10 ? 4 : (Bits == 12 ? 2 : 8 / Bits);
+
+		template <size_t Bits>
+		inline constexpr size_t packed_group_bytes = packed_group_samples<Bits> * Bits / 8;
+
+		/// Pack a single row of `width` samples into `dst` which must hold packed_image<Bits>::row_bytes_for(width)
+		/// bytes. Samples are truncated to their lower `Bits` bits.
+		///
+		/// \return The bitwise OR of all bits above `Bits` of the input samples, non-zero if any sample overflowed
+		template <size_t Bits, typename T>
+		uint64_t pack_row(const T* src, uint8_t* dst, size_t width) noexcept
+		{
+			using unsigned_type = std::make_unsigned_t<std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>>;
+			constexpr size_t group = packed_group_samples<Bits>;
+			constexpr size_t group_bytes = packed_group_bytes<Bits>;
+			constexpr uint64_t mask = (uint64_t{ 1 } << Bits) - 1;
+
+			uint64_t overflow = 0;
+			auto pack_group = [&](const T* samples, size_t count, uint8_t* out, size_t out_bytes)
+				{
+					uint64_t acc = 0;
+					for (size_t i = 0; i < group; ++i)
+					{
+						const uint64_t value = i < count ? static_cast<unsigned_type>(samples[i]) : 0;
+						overflow |= value & ~mask;
+						acc = (acc << Bits) | (value & mask);
+					}
+					for (size_t i = 0; i < out_bytes; ++i)
+					{
+						out[i] = static_cast<uint8_t>(acc >> (8 * (group_bytes - 1 - i)));
+					}
+				};
+
+			const size_t full_groups = width / group;
+			for (size_t g = 0; g < full_groups; ++g)
+			{
+				pack_group(src + g * group, group, dst + g * group_bytes, group_bytes);
+			}
+			if (const size_t tail = width % group; tail != 0)
+			{
+				// The last partial group is zero padded and only writes the bytes belonging to the row
+				const size_t tail_bytes = (tail * Bits + 7) / 8;
+				pack_group(src + full_groups * group, tail, dst + full_groups * group_bytes, tail_bytes);
+			}
+			return overflow;
+		}
+
+		/// Unpack a single row of `width` samples from `src` which must hold packed_image<Bits>::row_bytes_for(width)
+		/// bytes into `dst`.
+		template <size_t Bits, typename T>
+		void unpack_row(const uint8_t* src, T* dst, size_t width) noexcept
+		{
+			constexpr size_t group = packed_group_samples<Bits>;
+			constexpr size_t group_bytes = packed_group_bytes<Bits>;
+			constexpr uint64_t mask = (uint64_t{ 1 } << Bits) - 1;
+
+			auto unpack_group = [&](const uint8_t* in, size_t in_bytes, T* out, size_t count)
+				{
+					uint64_t acc = 0;
+					for (size_t i = 0; i < group_bytes; ++i)
+					{
+						acc = (acc << 8) | (i < in_bytes ? in[i] : 0u);
+					}
+					for (size_t i = 0; i < count; ++i)
+					{
+						out[i] = static_cast<T>((acc >> (Bits * (group - 1 - i))) & mask);
+					}
+				};
+
+			const size_t full_groups = width / group;
+			for (size_t g = 0; g < full_groups; ++g)
+			{
+				unpack_group(src + g * group_bytes, group_bytes, dst + g * group, group);
+			}
+			if (const size_t tail = width % group; tail != 0)
+			{
+				const size_t tail_bytes = (tail * Bits + 7) / 8;
+				unpack_group(src + full_groups * group_bytes, tail_bytes, dst + full_groups * group, tail);
+			}
+		}
+
+	} // detail
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
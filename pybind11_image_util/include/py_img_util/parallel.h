@@ -0,0 +1,106 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+#include "macros.h"
+#include "executor.h"
+#include "copy.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace detail
+	{
+
+		/// Minimum amount of bytes each parallel chunk should process, below this the cost of dispatching
+		/// work to another thread outweighs the gain.
+		inline constexpr size_t parallel_min_chunk_bytes = 256 * 1024;
+
+		/// Compute the number of items each chunk should hold such that a chunk processes at least
+		/// parallel_min_chunk_bytes given the number of bytes touched per item.
+		inline size_t parallel_grain_size(size_t bytes_per_item)
+		{
+			return std::max<size_t>(1, parallel_min_chunk_bytes / std::max<size_t>(1, bytes_per_item));
+		}
+
+		/// Split the range [0, count) into contiguous chunks of at least `grain_size` items and call
+		/// fn(begin, end) for each of them in parallel through current_executor(), blocking until all chunks have
+		/// completed. If the range only makes up a single chunk, fn is invoked inline on the calling thread.
+		///
+		/// The function must not call into python as it may run on threads not holding the GIL. If any
+		/// invocation throws, the first exception is rethrown on the calling thread once all chunks finished.
+		///
+		/// \param count The number of items to process
+		/// \param grain_size The minimum number of items per chunk
+		/// \param fn Callable with the signature void(size_t begin, size_t end)
+		template <typename Fn>
+		void parallel_for(size_t count, size_t grain_size, Fn&& fn)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			executor& exec = current_executor();
+			const size_t max_chunks = std::max<size_t>(1, exec.concurrency());
+			const size_t num_chunks = std::min(max_chunks, (count + grain_size - 1) / std::max<size_t>(1, grain_size));
+			if (num_chunks <= 1)
+			{
+				fn(size_t{ 0 }, count);
+				return;
+			}
+
+			const size_t chunk_size = (count + num_chunks - 1) / num_chunks;
+			std::vector<std::exception_ptr> exceptions(num_chunks);
+
+			auto run_chunk = [&](size_t chunk)
+				{
+					const size_t begin = chunk * chunk_size;
+					const size_t end = std::min(count, begin + chunk_size);
+					try
+					{
+						if (begin < end)
+						{
+							fn(begin, end);
+						}
+					}
+					catch (...)
+					{
+						exceptions[chunk] = std::current_exception();
+					}
+				};
+
+			exec.bulk_execute(num_chunks, run_chunk);
+
+			for (const auto& exception : exceptions)
+			{
+				if (exception)
+				{
+					std::rethrow_exception(exception);
+				}
+			}
+		}
+
+		/// Copy `count` elements from src to dst in parallel chunks. Besides splitting the memory bandwidth across
+		/// cores this spreads the page faults of a freshly allocated (untouched) destination across the threads.
+		/// Copies above streaming_copy_threshold() use non-temporal stores, see copy.h.
+		template <typename T>
+		void parallel_copy(const T* src, T* dst, size_t count)
+		{
+			const size_t total_bytes = count * sizeof(T);
+			parallel_for(count, parallel_grain_size(sizeof(T)), [&](size_t begin, size_t end)
+				{
+					detail::copy_elements(src + begin, dst + begin, end - begin, total_bytes);
+				});
+		}
+
+	} // detail
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
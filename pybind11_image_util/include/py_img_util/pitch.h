@@ -0,0 +1,34 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <cstddef>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	/// The distance between the start of two consecutive rows of an image buffer. Buffers whose rows are
+	/// padded (e.g. to SIMD-friendly 64-byte multiples) have a pitch larger than width * sizeof(T).
+	struct row_pitch
+	{
+		/// The pitch in bytes
+		size_t bytes = 0;
+
+		/// Construct a row pitch from a number of bytes
+		static constexpr row_pitch in_bytes(size_t bytes) noexcept { return row_pitch{ bytes }; }
+
+		/// Construct a row pitch from a number of elements of type T
+		template <typename T>
+		static constexpr row_pitch in_elements(size_t elements) noexcept { return row_pitch{ elements * sizeof(T) }; }
+
+		/// The pitch in number of elements of type T, only valid if the pitch is a multiple of sizeof(T)
+		template <typename T>
+		constexpr size_t elements() const noexcept { return bytes / sizeof(T); }
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,87 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <span>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	/// Non-owning, allocation-free view over a planar [channels, height, width] buffer, handing out a span per
+	/// channel. Like the spans returned by from_py_array(tag::view{}, ...) it must not outlive the buffer it
+	/// was created from.
+	///
+	/// \tparam T The element type
+	template <typename T>
+	class planar_view
+	{
+	public:
+
+		/// Forward iterator over the channels of the view
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::span<const T>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = std::span<const T>;
+
+			iterator() = default;
+			iterator(const planar_view* view, size_t channel) : m_View(view), m_Channel(channel) {}
+
+			std::span<const T> operator*() const { return (*m_View)[m_Channel]; }
+			iterator& operator++() { ++m_Channel; return *this; }
+			iterator operator++(int) { auto tmp = *this; ++m_Channel; return tmp; }
+			bool operator==(const iterator& other) const = default;
+
+		private:
+			const planar_view* m_View = nullptr;
+			size_t m_Channel = 0;
+		};
+
+		planar_view() = default;
+
+		/// Construct the view over a flat buffer which must hold channels * width * height elements
+		planar_view(std::span<const T> data, size_t channels, size_t width, size_t height)
+			: m_Data(data), m_Channels(channels), m_Width(width), m_Height(height)
+		{
+			assert(data.size() == channels * width * height);
+		}
+
+		/// The number of channels
+		size_t size() const noexcept { return m_Channels; }
+		bool empty() const noexcept { return m_Channels == 0; }
+		size_t width() const noexcept { return m_Width; }
+		size_t height() const noexcept { return m_Height; }
+
+		/// A span over the given channel holding width * height elements in row-major order
+		std::span<const T> operator[](size_t channel) const
+		{
+			assert(channel < m_Channels);
+			const size_t plane = m_Width * m_Height;
+			return m_Data.subspan(channel * plane, plane);
+		}
+
+		/// A flat span over all channels
+		std::span<const T> data() const noexcept { return m_Data; }
+
+		iterator begin() const { return iterator(this, 0); }
+		iterator end() const { return iterator(this, m_Channels); }
+
+	private:
+		std::span<const T> m_Data;
+		size_t m_Channels = 0;
+		size_t m_Width = 0;
+		size_t m_Height = 0;
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,37 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <type_traits>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	/// Validation policies which may be passed as trailing argument to the conversion functions to control 
+	/// how much validation is performed on the inputs.
+	namespace policy
+	{
+		/// Validate all inputs, raising a py::value_error on invalid input. This is the default.
+		struct checked {};
+
+		/// Validate inputs through assert(), these checks are compiled out with NDEBUG. Intended for callers 
+		/// which guarantee valid inputs but want to catch violations in debug builds.
+		struct debug {};
+
+		/// Skip all validation, only performing the pointer handoff and copy. The caller guarantees that the
+		/// shapes match and that numpy inputs are C-contiguous and non-null, violating this is undefined behaviour.
+		struct unchecked {};
+	}
+
+	template <typename T>
+	concept validation_policy = 
+		std::is_same_v<T, policy::checked> || 
+		std::is_same_v<T, policy::debug> || 
+		std::is_same_v<T, policy::unchecked>;
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
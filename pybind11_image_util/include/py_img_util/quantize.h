@@ -0,0 +1,112 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	/// Dithering applied while quantizing floating point data to integers
+	enum class dither_mode
+	{
+		/// Round to nearest
+		none,
+		/// Add a 4x4 Bayer threshold matrix (+-0.5 of an output step) before rounding, breaking up banding in
+		/// smooth gradients
+		ordered
+	};
+
+	/// Describes how floating point data is mapped onto an integer output type: values in [low, high] are mapped
+	/// linearly onto [0, max] of the output type, then clamped and rounded. NaN maps to 0.
+	struct quantization
+	{
+		/// The input value mapped to 0
+		double low = 0.0;
+		/// The input value mapped to the maximum of the output type
+		double high = 1.0;
+		dither_mode dither = dither_mode::none;
+	};
+
+	/// Whether float data of type T can be quantized into Out
+	template <typename T, typename Out>
+	inline constexpr bool is_quantizable_v = std::is_floating_point_v<T> && (std::is_same_v<Out, uint8_t> || std::is_same_v<Out, uint16_t>);
+
+
+	namespace detail
+	{
+
+		/// 4x4 Bayer matrix
+		inline constexpr std::array<std::array<uint8_t, 4>, 4> bayer_4x4 = { {
+			{ 0, 8, 2, 10 },
+			{ 12, 4, 14, 6 },
+			{ 3, 11, 1, 9 },
+			{ 15, 7, 13, 5 },
+		} };
+
+		/// Number of pixels processed per inner block of quantize_row, a multiple of the dither matrix width so
+		/// that the block loop has constant trip count and vectorizes.
+		inline constexpr size_t quantize_block = 16;
+
+		/// The per-column dither offsets of row `y`, repeated to fill a block, in units of output steps
+		template <typename T>
+		std::array<T, quantize_block> quantize_dither_pattern(size_t y, dither_mode dither) noexcept
+		{
+			std::array<T, quantize_block> pattern{};
+			if (dither == dither_mode::ordered)
+			{
+				for (size_t x = 0; x < quantize_block; ++x)
+				{
+					pattern[x] = (static_cast<T>(bayer_4x4[y % 4][x % 4]) + static_cast<T>(0.5)) / static_cast<T>(16) - static_cast<T>(0.5);
+				}
+			}
+			return pattern;
+		}
+
+		/// Quantize a single row of `width` values into dst, i.e. dst[x] = round(clamp(src[x] * scale + offset + dither, 0, max)).
+		/// The loop is written branch free over fixed size blocks so the compiler emits SIMD code for it.
+		template <typename T, typename Out>
+			requires is_quantizable_v<T, Out>
+		void quantize_row(const T* src, Out* dst, size_t width, T scale, T offset, const std::array<T, quantize_block>& pattern) noexcept
+		{
+			constexpr T max_value = static_cast<T>(std::numeric_limits<Out>::max());
+			// Rounding half up is folded into the offset so that clamping and truncation yield the rounded value
+			const T rounded_offset = offset + static_cast<T>(0.5);
+			auto quantize_one = [&](T value, T dither)
+				{
+					T v = value * scale + rounded_offset + dither;
+					// Written as comparisons rather than std::clamp so NaN maps to 0 and this lowers to min/max. 
+					// Converting through int32 rather than directly to Out is what allows the loop to vectorize
+					v = v > T(0) ? v : T(0);
+					v = v < max_value ? v : max_value;
+					return static_cast<Out>(static_cast<int32_t>(v));
+				};
+
+			const size_t full_blocks = width / quantize_block;
+			for (size_t block = 0; block < full_blocks; ++block)
+			{
+				const T* block_src = src + block * quantize_block;
+				Out* block_dst = dst + block * quantize_block;
+				for (size_t i = 0; i < quantize_block; ++i)
+				{
+					block_dst[i] = quantize_one(block_src[i], pattern[i]);
+				}
+			}
+			for (size_t x = full_blocks * quantize_block; x < width; ++x)
+			{
+				dst[x] = quantize_one(src[x], pattern[x % quantize_block]);
+			}
+		}
+
+	} // detail
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,165 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <format>
+#include <span>
+#include <cstring>
+#include <cstddef>
+#include <utility>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "macros.h"
+#include "validation.h"
+#include "detail.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	/// Packs many small outputs into a single refcounted allocation, handing each one to python as a numpy array
+	/// viewing into it. Rather than one heap allocation plus a capsule per array, a batch of n arrays costs a
+	/// single allocation (if reserve() was called up front) and a single capsule. The slab is freed once the last
+	/// array referencing it dies.
+	///
+	/// The data passed to add() is copied immediately so it does not have to outlive the arena.
+	///
+	/// \code{.cpp}
+	/// py_img_util::slab_arena arena;
+	/// arena.reserve<uint8_t>(masks.size() * mask_size);
+	/// for (const auto& mask : masks)
+	/// {
+	///		arena.add(std::span<const uint8_t>(mask), width, height);
+	/// }
+	/// std::vector<py::array> arrays = arena.build();
+	/// \endcode
+	class slab_arena
+	{
+	public:
+		/// Alignment of each entry within the slab
+		static constexpr size_t alignment = alignof(std::max_align_t);
+
+		/// Maximum number of dimensions of a single entry, shapes are stored inline so adding an entry only ever
+		/// allocates when the slab itself has to grow
+		static constexpr size_t max_dims = 4;
+
+		/// Reserve space for `count` elements of type T, call this up front to keep the number of allocations per
+		/// batch at one. Entries are padded to `alignment` so reserve some slack when adding many odd-sized entries.
+		template <typename T>
+		void reserve(size_t count)
+		{
+			m_Storage.reserve(m_Storage.size() + count * sizeof(T) + alignment);
+		}
+
+		/// Append an entry of the given shape, copying the data into the slab.
+		///
+		/// \param data The row-major data of the entry
+		/// \param shape The numpy shape of the entry, with 1 to max_dims dimensions
+		/// \throws py::value_error if the number of dimensions is unsupported or the data size does not match the shape
+		/// \return The index of the entry in the vector returned by build()
+		template <typename T>
+		size_t add(std::span<const T> data, std::span<const size_t> shape)
+		{
+			if (shape.empty() || shape.size() > max_dims)
+			{
+				throw py::value_error(std::format("slab_arena entries must have between 1 and {:L} dimensions, got {:L}", max_dims, shape.size()));
+			}
+			entry_type entry{ .make = &make_array<T> };
+			size_t size = 1;
+			for (size_t i = 0; i < shape.size(); ++i)
+			{
+				entry.shape[i] = shape[i];
+				size *= shape[i];
+			}
+			entry.ndim = shape.size();
+			if (size != data.size())
+			{
+				// Only the error path allocates, reusing the message of the regular shape check
+				detail::check_cpp_span_matches_shape(data, std::vector<size_t>(shape.begin(), shape.end()));
+			}
+
+			entry.offset = (m_Storage.size() + alignment - 1) / alignment * alignment;
+			m_Storage.resize(entry.offset + data.size_bytes());
+			std::memcpy(m_Storage.data() + entry.offset, data.data(), data.size_bytes());
+
+			m_Entries.push_back(entry);
+			return m_Entries.size() - 1;
+		}
+
+		/// Append an entry of shape [height, width], copying the data into the slab.
+		///
+		/// \see add(std::span<const T>, std::span<const size_t>)
+		template <typename T>
+		size_t add(std::span<const T> data, size_t width, size_t height)
+		{
+			const std::array<size_t, 2> shape = { height, width };
+			return add(data, std::span<const size_t>(shape));
+		}
+
+		/// Number of entries added since the last build()
+		size_t size() const noexcept { return m_Entries.size(); }
+
+		/// Number of bytes currently held by the slab including alignment padding
+		size_t bytes() const noexcept { return m_Storage.size(); }
+
+		/// Hand the slab over to python, returning one numpy array per entry in the order they were added. All
+		/// arrays share ownership of the slab. Leaves the arena empty so it can be reused for the next batch.
+		std::vector<py::array> build()
+		{
+			auto entries = std::exchange(m_Entries, {});
+			auto storage = std::exchange(m_Storage, {});
+
+			std::byte* base = storage.data();
+			auto capsule = detail::to_py::capsule_from_vector(std::move(storage));
+
+			std::vector<py::array> out;
+			out.reserve(entries.size());
+			for (const auto& entry : entries)
+			{
+				out.push_back(entry.make(entry, base + entry.offset, capsule));
+			}
+			return out;
+		}
+
+	private:
+		struct entry_type;
+		using make_array_fn = py::array(*)(const entry_type&, std::byte*, const py::capsule&);
+
+		struct entry_type
+		{
+			size_t offset = 0;
+			std::array<size_t, max_dims> shape{};
+			size_t ndim = 0;
+			make_array_fn make = nullptr;
+		};
+
+		std::vector<std::byte> m_Storage;
+		std::vector<entry_type> m_Entries;
+
+		template <typename T>
+		static py::array make_array(const entry_type& entry, std::byte* ptr, const py::capsule& capsule)
+		{
+			std::array<size_t, max_dims> strides{};
+			size_t stride = sizeof(T);
+			for (size_t i = entry.ndim; i-- > 0;)
+			{
+				strides[i] = stride;
+				stride *= entry.shape[i];
+			}
+			return py::array_t<T>(
+				py::array::ShapeContainer(entry.shape.begin(), entry.shape.begin() + entry.ndim),
+				py::array::StridesContainer(strides.begin(), strides.begin() + entry.ndim),
+				reinterpret_cast<T*>(ptr),
+				capsule);
+		}
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,285 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <format>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+
+#include <pybind11/pybind11.h>
+
+#include "macros.h"
+#include "parallel.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	namespace detail
+	{
+		/// Bitwise comparison of two values, unlike operator== this treats identical NaNs as equal and +0/-0 as
+		/// different which is what we want when deciding whether a tile can be reconstructed from a single value.
+		template <typename T>
+		bool bitwise_equal(const T& a, const T& b) noexcept
+		{
+			return std::memcmp(&a, &b, sizeof(T)) == 0;
+		}
+	} // detail
+
+
+	/// Image stored as a grid of square tiles where tiles whose pixels are all identical are stored as a single
+	/// fill value and only the remaining tiles hold dense pixel data. Mostly empty layers, fully opaque alphas or
+	/// constant masks therefore only take up a fraction of the memory of a dense buffer.
+	///
+	/// Tiles on the right and bottom edge are cropped to the image bounds. Dense tiles are stored back to back, each
+	/// tile in row-major order with its own (possibly cropped) width as row length.
+	///
+	/// \tparam T The element type
+	template <typename T>
+	class sparse_image
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "sparse_image requires a trivially copyable element type");
+
+	public:
+		/// Default tile size in pixels along each axis
+		static constexpr size_t default_tile_size = 64;
+
+		sparse_image() = default;
+
+		/// Generate the sparse representation of a row-major buffer of width * height elements. Tiles are scanned
+		/// in parallel, the scan of a non-uniform tile stops at its first differing pixel after which only the
+		/// dense tiles are copied. This does not call into python and may be called with the GIL released.
+		///
+		/// \throws py::value_error if the tile size is zero or the buffer does not hold width * height elements
+		static sparse_image from_dense(std::span<const T> data, size_t width, size_t height, size_t tile_size = default_tile_size)
+		{
+			if (tile_size == 0)
+			{
+				throw py::value_error("Unable to generate a sparse_image with a tile size of zero");
+			}
+			if (data.size() != width * height)
+			{
+				throw py::value_error(
+					std::format(
+						"Invalid data size passed to sparse_image, expected {:L} but instead got {:L}",
+						width * height, data.size()
+					)
+				);
+			}
+
+			sparse_image image;
+			image.m_Width = width;
+			image.m_Height = height;
+			image.m_TileSize = tile_size;
+			image.m_Tiles.resize(image.tiles_x() * image.tiles_y());
+
+			// Pass 1: find the uniform tiles, tile rows are processed in parallel
+			const T* src = data.data();
+			const size_t grain = detail::parallel_grain_size(tile_size * width * sizeof(T));
+			detail::parallel_for(image.tiles_y(), grain, [&](size_t begin, size_t end)
+				{
+					for (size_t ty = begin; ty < end; ++ty)
+					{
+						for (size_t tx = 0; tx < image.tiles_x(); ++tx)
+						{
+							auto& tile = image.m_Tiles[ty * image.tiles_x() + tx];
+							const auto [x0, y0, w, h] = image.tile_bounds(tx, ty);
+							tile.value = src[y0 * width + x0];
+							tile.uniform = true;
+							for (size_t y = y0; y < y0 + h && tile.uniform; ++y)
+							{
+								const T* row = src + y * width + x0;
+								for (size_t x = 0; x < w; ++x)
+								{
+									if (!detail::bitwise_equal(row[x], tile.value))
+									{
+										tile.uniform = false;
+										break;
+									}
+								}
+							}
+						}
+					}
+				});
+
+			// Assign the dense tiles their offsets into the dense storage
+			size_t dense_size = 0;
+			for (size_t ty = 0; ty < image.tiles_y(); ++ty)
+			{
+				for (size_t tx = 0; tx < image.tiles_x(); ++tx)
+				{
+					auto& tile = image.m_Tiles[ty * image.tiles_x() + tx];
+					if (!tile.uniform)
+					{
+						const auto bounds = image.tile_bounds(tx, ty);
+						tile.offset = dense_size;
+						dense_size += bounds.width * bounds.height;
+					}
+				}
+			}
+
+			// Pass 2: copy the dense tiles
+			image.m_Dense.resize(dense_size);
+			T* dense = image.m_Dense.data();
+			detail::parallel_for(image.tiles_y(), grain, [&](size_t begin, size_t end)
+				{
+					for (size_t ty = begin; ty < end; ++ty)
+					{
+						for (size_t tx = 0; tx < image.tiles_x(); ++tx)
+						{
+							const auto& tile = image.m_Tiles[ty * image.tiles_x() + tx];
+							if (tile.uniform)
+							{
+								continue;
+							}
+							const auto [x0, y0, w, h] = image.tile_bounds(tx, ty);
+							for (size_t y = 0; y < h; ++y)
+							{
+								std::memcpy(dense + tile.offset + y * w, src + (y0 + y) * width + x0, w * sizeof(T));
+							}
+						}
+					}
+				});
+			return image;
+		}
+
+		size_t width() const noexcept { return m_Width; }
+		size_t height() const noexcept { return m_Height; }
+		size_t tile_size() const noexcept { return m_TileSize; }
+
+		/// Number of tiles along the x and y axis
+		size_t tiles_x() const noexcept { return m_TileSize == 0 ? 0 : (m_Width + m_TileSize - 1) / m_TileSize; }
+		size_t tiles_y() const noexcept { return m_TileSize == 0 ? 0 : (m_Height + m_TileSize - 1) / m_TileSize; }
+
+		/// Whether the given tile is stored as a single fill value
+		bool is_uniform(size_t tile_x, size_t tile_y) const { return tile_at(tile_x, tile_y).uniform; }
+
+		/// The fill value of a uniform tile
+		T fill_value(size_t tile_x, size_t tile_y) const
+		{
+			assert(is_uniform(tile_x, tile_y));
+			return tile_at(tile_x, tile_y).value;
+		}
+
+		/// The row-major data of a dense tile, rows are as wide as the (possibly cropped) tile
+		std::span<const T> tile_data(size_t tile_x, size_t tile_y) const
+		{
+			const auto& tile = tile_at(tile_x, tile_y);
+			assert(!tile.uniform);
+			const auto bounds = tile_bounds(tile_x, tile_y);
+			return std::span<const T>(m_Dense).subspan(tile.offset, bounds.width * bounds.height);
+		}
+
+		/// Number of tiles holding dense data
+		size_t dense_tile_count() const noexcept
+		{
+			return static_cast<size_t>(std::count_if(m_Tiles.begin(), m_Tiles.end(), [](const auto& tile) { return !tile.uniform; }));
+		}
+
+		/// Approximate number of bytes held by the sparse representation
+		size_t memory_bytes() const noexcept
+		{
+			return m_Dense.size() * sizeof(T) + m_Tiles.size() * sizeof(tile_type);
+		}
+
+		/// The pixel at the given coordinate
+		T at(size_t x, size_t y) const
+		{
+			assert(x < m_Width && y < m_Height);
+			const size_t tile_x = x / m_TileSize;
+			const size_t tile_y = y / m_TileSize;
+			const auto& tile = tile_at(tile_x, tile_y);
+			if (tile.uniform)
+			{
+				return tile.value;
+			}
+			const auto bounds = tile_bounds(tile_x, tile_y);
+			return m_Dense[tile.offset + (y - bounds.y) * bounds.width + (x - bounds.x)];
+		}
+
+		/// Expand the image into a row-major buffer of width * height elements. Rows of tiles are expanded in
+		/// parallel, this does not call into python and may be called with the GIL released.
+		void expand_into(std::span<T> out) const
+		{
+			assert(out.size() == m_Width * m_Height);
+			T* dst = out.data();
+			const size_t grain = detail::parallel_grain_size(m_TileSize * m_Width * sizeof(T));
+			detail::parallel_for(tiles_y(), grain, [&](size_t begin, size_t end)
+				{
+					for (size_t ty = begin; ty < end; ++ty)
+					{
+						for (size_t tx = 0; tx < tiles_x(); ++tx)
+						{
+							const auto& tile = tile_at(tx, ty);
+							const auto [x0, y0, w, h] = tile_bounds(tx, ty);
+							for (size_t y = 0; y < h; ++y)
+							{
+								T* dst_row = dst + (y0 + y) * m_Width + x0;
+								if (tile.uniform)
+								{
+									std::fill_n(dst_row, w, tile.value);
+								}
+								else
+								{
+									std::memcpy(dst_row, m_Dense.data() + tile.offset + y * w, w * sizeof(T));
+								}
+							}
+						}
+					}
+				});
+		}
+
+		/// Expand the image into a dense row-major vector
+		std::vector<T> to_dense() const
+		{
+			std::vector<T> out(m_Width * m_Height);
+			expand_into(out);
+			return out;
+		}
+
+	private:
+		struct tile_type
+		{
+			bool uniform = true;
+			T value = {};
+			/// Offset into m_Dense, only valid for non-uniform tiles
+			size_t offset = 0;
+		};
+
+		struct bounds_type
+		{
+			size_t x = 0;
+			size_t y = 0;
+			size_t width = 0;
+			size_t height = 0;
+		};
+
+		size_t m_Width = 0;
+		size_t m_Height = 0;
+		size_t m_TileSize = 0;
+		std::vector<tile_type> m_Tiles;
+		std::vector<T> m_Dense;
+
+		const tile_type& tile_at(size_t tile_x, size_t tile_y) const
+		{
+			assert(tile_x < tiles_x() && tile_y < tiles_y());
+			return m_Tiles[tile_y * tiles_x() + tile_x];
+		}
+
+		bounds_type tile_bounds(size_t tile_x, size_t tile_y) const noexcept
+		{
+			const size_t x = tile_x * m_TileSize;
+			const size_t y = tile_y * m_TileSize;
+			return { x, y, std::min(m_TileSize, m_Width - x), std::min(m_TileSize, m_Height - y) };
+		}
+	};
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,332 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <array>
+#include <vector>
+#include <string>
+#include <span>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "macros.h"
+
+
+// Scoped tracing of the individual conversion steps (validation, forcecast, allocation, copy, capsule creation).
+// Compiled out entirely unless PY_IMAGE_UTIL_ENABLE_TRACING is defined (see the CMake option of the same name),
+// in which case the arguments to the macro are not evaluated either.
+//
+// Usage: PY_IMG_UTIL_TRACE_SCOPE("copy", py_img_util::trace::dtype_name<T>(), shape, bytes);
+#define PY_IMG_UTIL_TRACE_CONCAT_IMPL(a, b) a##b
+#define PY_IMG_UTIL_TRACE_CONCAT(a, b) PY_IMG_UTIL_TRACE_CONCAT_IMPL(a, b)
+
+#if defined(PY_IMAGE_UTIL_ENABLE_TRACING)
+#define PY_IMG_UTIL_TRACE_SCOPE(...) ::NAMESPACE_PY_IMAGE_UTIL::trace::scoped_span PY_IMG_UTIL_TRACE_CONCAT(_py_img_util_trace_, __LINE__)(__VA_ARGS__)
+#else
+#define PY_IMG_UTIL_TRACE_SCOPE(...) ((void)0)
+#endif
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	namespace trace
+	{
+
+		/// Whether the library was compiled with tracing support
+		inline constexpr bool enabled =
+#if defined(PY_IMAGE_UTIL_ENABLE_TRACING)
+			true;
+#else
+			false;
+#endif
+
+		/// Maximum number of dimensions recorded per event, higher dimensions are dropped
+		inline constexpr size_t max_dims = 4;
+
+		/// Number of events each thread keeps before overwriting the oldest ones
+		inline constexpr size_t ring_capacity = 4096;
+
+		/// The numpy-style name of the given arithmetic type, e.g. "float32" or "uint16"
+		template <typename T>
+		constexpr const char* dtype_name()
+		{
+			if constexpr (std::is_same_v<T, bool>) return "bool";
+			else if constexpr (std::is_floating_point_v<T>)
+			{
+				if constexpr (sizeof(T) == 2) return "float16";
+				else if constexpr (sizeof(T) == 4) return "float32";
+				else return "float64";
+			}
+			else if constexpr (std::is_signed_v<T>)
+			{
+				if constexpr (sizeof(T) == 1) return "int8";
+				else if constexpr (sizeof(T) == 2) return "int16";
+				else if constexpr (sizeof(T) == 4) return "int32";
+				else return "int64";
+			}
+			else if constexpr (std::is_unsigned_v<T>)
+			{
+				if constexpr (sizeof(T) == 1) return "uint8";
+				else if constexpr (sizeof(T) == 2) return "uint16";
+				else if constexpr (sizeof(T) == 4) return "uint32";
+				else return "uint64";
+			}
+			else
+			{
+				return "unknown";
+			}
+		}
+
+		/// A single completed span. Names and dtypes must be string literals as only the pointer is stored.
+		struct event
+		{
+			const char* name = nullptr;
+			const char* dtype = nullptr;
+			std::array<size_t, max_dims> shape = {};
+			uint8_t ndim = 0;
+			size_t bytes = 0;
+			int64_t begin_ns = 0;
+			int64_t end_ns = 0;
+		};
+
+
+		namespace detail
+		{
+
+			inline int64_t now_ns() noexcept
+			{
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()
+				).count();
+			}
+
+			/// Single-producer ring buffer owned by one thread. Writing never blocks or allocates, each slot is guarded
+			/// by a sequence number (odd while being written) so a concurrent reader can skip slots being overwritten.
+			class ring_buffer
+			{
+			public:
+				explicit ring_buffer(uint32_t thread_id) : m_ThreadId(thread_id) {}
+
+				void push(const event& e) noexcept
+				{
+					const uint64_t index = m_Head.load(std::memory_order_relaxed);
+					auto& slot = m_Slots[index % ring_capacity];
+					const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+					slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_release);
+					slot.value = e;
+					slot.sequence.store(sequence + 2, std::memory_order_release);
+					m_Head.store(index + 1, std::memory_order_release);
+				}
+
+				/// Append a consistent copy of all events currently held by the buffer
+				void collect(std::vector<event>& out) const
+				{
+					const uint64_t head = m_Head.load(std::memory_order_acquire);
+					const uint64_t begin = std::max(head > ring_capacity ? head - ring_capacity : 0, m_Tail.load(std::memory_order_relaxed));
+					for (uint64_t i = begin; i < head; ++i)
+					{
+						const auto& slot = m_Slots[i % ring_capacity];
+						const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+						if (before % 2 != 0)
+						{
+							continue;
+						}
+						event copy = slot.value;
+						std::atomic_thread_fence(std::memory_order_acquire);
+						if (slot.sequence.load(std::memory_order_relaxed) == before && copy.name)
+						{
+							out.push_back(copy);
+						}
+					}
+				}
+
+				/// Hide all events pushed so far from collect(), never touches the slots themselves
+				void clear() noexcept
+				{
+					m_Tail.store(m_Head.load(std::memory_order_acquire), std::memory_order_relaxed);
+				}
+
+				uint32_t thread_id() const noexcept { return m_ThreadId; }
+
+			private:
+				struct slot_type
+				{
+					std::atomic<uint64_t> sequence = 0;
+					event value;
+				};
+
+				std::array<slot_type, ring_capacity> m_Slots;
+				std::atomic<uint64_t> m_Head = 0;
+				std::atomic<uint64_t> m_Tail = 0;
+				uint32_t m_ThreadId = 0;
+			};
+
+			/// All ring buffers ever created, buffers outlive their threads so their events can still be dumped.
+			/// The mutex is only taken once per thread on its first event and when dumping.
+			struct trace_registry
+			{
+				std::mutex mutex;
+				std::vector<std::shared_ptr<ring_buffer>> buffers;
+			};
+
+			inline trace_registry& trace_registry_instance()
+			{
+				static trace_registry registry;
+				return registry;
+			}
+
+			inline ring_buffer& thread_ring_buffer()
+			{
+				thread_local std::shared_ptr<ring_buffer> buffer = []()
+					{
+						auto& registry = trace_registry_instance();
+						std::lock_guard lock(registry.mutex);
+						auto out = std::make_shared<ring_buffer>(static_cast<uint32_t>(registry.buffers.size()));
+						registry.buffers.push_back(out);
+						return out;
+					}();
+				return *buffer;
+			}
+
+		} // detail
+
+
+		/// Records the time between its construction and destruction as an event in the calling threads' ring buffer.
+		/// Prefer the PY_IMG_UTIL_TRACE_SCOPE macro which compiles to nothing when tracing is disabled.
+		class scoped_span
+		{
+		public:
+			scoped_span(const char* name, const char* dtype, std::span<const size_t> shape, size_t bytes) noexcept
+			{
+				m_Event.name = name;
+				m_Event.dtype = dtype;
+				m_Event.ndim = static_cast<uint8_t>(std::min(shape.size(), max_dims));
+				std::copy_n(shape.begin(), m_Event.ndim, m_Event.shape.begin());
+				m_Event.bytes = bytes;
+				m_Event.begin_ns = detail::now_ns();
+			}
+
+			template <typename T>
+			scoped_span(const char* name, const py::array_t<T>& array) noexcept
+			{
+				m_Event.name = name;
+				m_Event.dtype = dtype_name<T>();
+				m_Event.ndim = static_cast<uint8_t>(std::min(static_cast<size_t>(array.ndim()), max_dims));
+				for (size_t i = 0; i < m_Event.ndim; ++i)
+				{
+					m_Event.shape[i] = static_cast<size_t>(array.shape(i));
+				}
+				m_Event.bytes = static_cast<size_t>(array.nbytes());
+				m_Event.begin_ns = detail::now_ns();
+			}
+
+			scoped_span(const scoped_span&) = delete;
+			scoped_span& operator=(const scoped_span&) = delete;
+
+			~scoped_span()
+			{
+				m_Event.end_ns = detail::now_ns();
+				detail::thread_ring_buffer().push(m_Event);
+			}
+
+		private:
+			event m_Event;
+		};
+
+
+		/// Discard all events recorded so far
+		inline void clear()
+		{
+			auto& registry = detail::trace_registry_instance();
+			std::lock_guard lock(registry.mutex);
+			for (const auto& buffer : registry.buffers)
+			{
+				buffer->clear();
+			}
+		}
+
+		/// Serialize all events currently held by the ring buffers into the Chrome trace event format which can
+		/// be loaded into chrome://tracing or https://ui.perfetto.dev
+		inline std::string to_chrome_json()
+		{
+			std::string out = "{\"traceEvents\":[";
+			bool first = true;
+			std::vector<event> events;
+
+			auto& registry = detail::trace_registry_instance();
+			std::lock_guard lock(registry.mutex);
+			for (const auto& buffer : registry.buffers)
+			{
+				events.clear();
+				buffer->collect(events);
+				for (const auto& e : events)
+				{
+					std::string shape;
+					for (size_t i = 0; i < e.ndim; ++i)
+					{
+						shape += std::format("{}{}", i == 0 ? "" : ",", e.shape[i]);
+					}
+					out += std::format(
+						"{}{{\"name\":\"{}\",\"cat\":\"py_img_util\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},"
+						"\"args\":{{\"dtype\":\"{}\",\"shape\":[{}],\"bytes\":{}}}}}",
+						first ? "" : ",",
+						e.name,
+						buffer->thread_id(),
+						static_cast<double>(e.begin_ns) / 1000.0,
+						static_cast<double>(e.end_ns - e.begin_ns) / 1000.0,
+						e.dtype ? e.dtype : "",
+						shape,
+						e.bytes
+					);
+					first = false;
+				}
+			}
+			out += "]}";
+			return out;
+		}
+
+		/// Write the Chrome trace JSON of all recorded events to the given file
+		///
+		/// \throws std::runtime_error if the file could not be opened
+		inline void dump_chrome_json(const std::string& path)
+		{
+			std::ofstream file(path, std::ios::binary);
+			if (!file)
+			{
+				throw std::runtime_error(std::format("Unable to open trace file '{}' for writing", path));
+			}
+			file << to_chrome_json();
+		}
+
+		/// Register the tracing functions on the given python module:
+		///
+		/// - `tracing_enabled() -> bool`
+		/// - `dump_trace(path: str)`
+		/// - `clear_trace()`
+		inline void bind(py::module_& m)
+		{
+			m.def("tracing_enabled", []() { return enabled; });
+			m.def("dump_trace", &dump_chrome_json, py::arg("path"));
+			m.def("clear_trace", &clear);
+		}
+
+	} // trace
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -0,0 +1,207 @@
+// Copyright Contributors to the pybind11_image_util project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/EmilDohne/pybind11_image_util
+
+#pragma once
+
+#include <format>
+#include <vector>
+#include <array>
+#include <span>
+#include <utility>
+#include <type_traits>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "macros.h"
+
+
+namespace NAMESPACE_PY_IMAGE_UTIL
+{
+
+	namespace py = pybind11;
+
+	/// Memory layout of a multi-channel image
+	enum class layout
+	{
+		/// Channels are stored one after another, numpy shape [channels, height, width]
+		planar,
+		/// Channels are stored per pixel, numpy shape [height, width, channels]
+		interleaved
+	};
+
+
+	/// Image with its element type, channel layout and number of channels known at compile time.
+	///
+	/// Unlike the flat std::vector overloads the rank, shape order and strides of the numpy representation
+	/// are fully determined by the template arguments. Single channel images are represented as 2D arrays
+	/// of shape [height, width] irrespective of the layout.
+	///
+	/// \tparam T The element type
+	/// \tparam Layout Whether the channels are stored planar or interleaved
+	/// \tparam Channels The number of channels
+	template <typename T, layout Layout, size_t Channels>
+	class typed_image
+	{
+		static_assert(std::is_arithmetic_v<T>, "typed_image requires an arithmetic element type");
+		static_assert(Channels > 0, "typed_image requires at least one channel");
+
+	public:
+		using value_type = T;
+		static constexpr layout image_layout = Layout;
+		static constexpr size_t channels = Channels;
+		/// Number of dimensions of the numpy representation
+		static constexpr size_t ndim = Channels == 1 ? 2 : 3;
+
+		using shape_type = std::array<size_t, ndim>;
+
+		typed_image() = default;
+
+		/// Construct a zero-initialized image of the given size
+		typed_image(size_t width, size_t height)
+			: m_Data(width * height * Channels), m_Width(width), m_Height(height) {}
+
+		/// Construct an image from existing data which must be of size width * height * Channels
+		/// and stored according to Layout.
+		///
+		/// \throws py::value_error if the data size does not match
+		typed_image(std::vector<T> data, size_t width, size_t height)
+			: m_Data(std::move(data)), m_Width(width), m_Height(height)
+		{
+			if (m_Data.size() != width * height * Channels)
+			{
+				throw py::value_error(
+					std::format(
+						"Invalid data size passed to typed_image, expected {:L} but instead got {:L}",
+						width * height * Channels, m_Data.size()
+					)
+				);
+			}
+		}
+
+		/// The numpy shape for an image of the given size
+		static constexpr shape_type shape_for(size_t width, size_t height)
+		{
+			if constexpr (Channels == 1)
+			{
+				return { height, width };
+			}
+			else if constexpr (Layout == layout::planar)
+			{
+				return { Channels, height, width };
+			}
+			else
+			{
+				return { height, width, Channels };
+			}
+		}
+
+		/// The C-style numpy strides (in bytes) for an image of the given size
+		static constexpr shape_type strides_for(size_t width, size_t height)
+		{
+			if constexpr (Channels == 1)
+			{
+				return { width * sizeof(T), sizeof(T) };
+			}
+			else if constexpr (Layout == layout::planar)
+			{
+				return { height * width * sizeof(T), width * sizeof(T), sizeof(T) };
+			}
+			else
+			{
+				return { width * Channels * sizeof(T), Channels * sizeof(T), sizeof(T) };
+			}
+		}
+
+		/// Flat index of the given channel and pixel into data()
+		static constexpr size_t index_for(size_t width, size_t height, size_t channel, size_t y, size_t x)
+		{
+			if constexpr (Layout == layout::planar)
+			{
+				return channel * width * height + y * width + x;
+			}
+			else
+			{
+				return (y * width + x) * Channels + channel;
+			}
+		}
+
+		constexpr shape_type shape() const { return shape_for(m_Width, m_Height); }
+		constexpr shape_type strides() const { return strides_for(m_Width, m_Height); }
+
+		size_t width() const noexcept { return m_Width; }
+		size_t height() const noexcept { return m_Height; }
+
+		std::span<T> data() noexcept { return m_Data; }
+		std::span<const T> data() const noexcept { return m_Data; }
+
+		/// Release the underlying storage, leaving the image empty
+		std::vector<T> release() &&
+		{
+			m_Width = 0;
+			m_Height = 0;
+			return std::move(m_Data);
+		}
+
+		T& operator()(size_t channel, size_t y, size_t x) { return m_Data[index_for(m_Width, m_Height, channel, y, x)]; }
+		const T& operator()(size_t channel, size_t y, size_t x) const { return m_Data[index_for(m_Width, m_Height, channel, y, x)]; }
+
+		/// A view over a single channel, only available for planar images
+		std::span<const T> channel(size_t index) const requires (Layout == layout::planar)
+		{
+			const size_t plane = m_Width * m_Height;
+			return std::span<const T>(m_Data).subspan(index * plane, plane);
+		}
+
+		/// Convert the image into the other layout, single channel images are simply copied.
+		template <layout NewLayout>
+		typed_image<T, NewLayout, Channels> to_layout() const
+		{
+			if constexpr (NewLayout == Layout || Channels == 1)
+			{
+				return typed_image<T, NewLayout, Channels>(m_Data, m_Width, m_Height);
+			}
+			else
+			{
+				const size_t plane = m_Width * m_Height;
+				std::vector<T> out(m_Data.size());
+				const T* src = m_Data.data();
+				T* dst = out.data();
+				for (size_t i = 0; i < plane; ++i)
+				{
+					// The channel loop is unrolled at compile time
+					[&]<size_t... C>(std::index_sequence<C...>)
+					{
+						if constexpr (Layout == layout::planar)
+						{
+							((dst[i * Channels + C] = src[C * plane + i]), ...);
+						}
+						else
+						{
+							((dst[C * plane + i] = src[i * Channels + C]), ...);
+						}
+					}(std::make_index_sequence<Channels>{});
+				}
+				return typed_image<T, NewLayout, Channels>(std::move(out), m_Width, m_Height);
+			}
+		}
+
+	private:
+		std::vector<T> m_Data;
+		size_t m_Width = 0;
+		size_t m_Height = 0;
+	};
+
+
+	/// Whether the given type is a specialization of typed_image
+	template <typename>
+	struct is_typed_image : std::false_type {};
+
+	template <typename T, layout Layout, size_t Channels>
+	struct is_typed_image<typed_image<T, Layout, Channels>> : std::true_type {};
+
+	template <typename T>
+	inline constexpr bool is_typed_image_v = is_typed_image<T>::value;
+
+} // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
@@ -9,11 +9,21 @@
 #include <unordered_map>
 #include <string>
 #include <span>
+#include <array>
+#include <algorithm>
+#include <optional>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+#include <functional>
 
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 #include "macros.h"
+#include "policy.h"
+#include "pitch.h"
+#include "trace.h"
 
 
 namespace NAMESPACE_PY_IMAGE_UTIL
@@ -23,46 +33,218 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 	namespace detail
 	{
 
-		/// Generate a shape array from the py::array_t checking at runtime whether the shape fits into the allowed dims and matches total_size
+		/// Error codes reported by the non-throwing try_* validation functions
+		enum class validation_errc : uint8_t
+		{
+			none = 0,
+			/// The array has a number of dimensions not contained in the allowed dimensions
+			invalid_ndim,
+			/// The total number of elements does not match the expected size
+			invalid_size,
+			/// A single dimension does not match its expected size
+			invalid_dimension,
+			/// The shape has a number of dimensions other than 1, 2 or 3
+			unsupported_ndim,
+			/// The array data resolves to a nullptr
+			null_data,
+		};
+
+
+		/// Lightweight description of a validation failure as returned by the try_* validation functions.
+		/// 
+		/// This only stores the error code and the values describing the failure, the human-readable message
+		/// is formatted lazily when calling message(). This keeps failing validation cheap for callers that
+		/// probe many arrays and discard most errors. Converts to true if it holds an error.
+		struct validation_error
+		{
+			validation_errc code = validation_errc::none;
+			/// The index of the offending dimension, only used for validation_errc::invalid_dimension
+			uint8_t dimension = 0;
+			/// The number of dimensions of the shape that was validated
+			uint8_t ndim = 0;
+			/// Bitmask of the allowed number of dimensions, only used for validation_errc::invalid_ndim
+			uint64_t allowed_dims = 0;
+			size_t expected = 0;
+			size_t actual = 0;
+
+			explicit operator bool() const noexcept { return code != validation_errc::none; }
+
+			/// Format the error message, this matches the message the throwing validation functions raise.
+			std::string message() const
+			{
+				switch (code)
+				{
+				case validation_errc::none:
+					return {};
+				case validation_errc::invalid_ndim:
+				{
+					std::string error_msg = "Invalid number of dimensions received, array must have one of the following number of dimensions: { ";
+					bool first = true;
+					for (size_t i = 0; i < 64; ++i)
+					{
+						if (allowed_dims & (uint64_t{ 1 } << i))
+						{
+							error_msg += (first ? "" : ", ") + std::to_string(i);
+							first = false;
+						}
+					}
+					error_msg += " }. Instead got: " + std::to_string(actual);
+					return error_msg;
+				}
+				case validation_errc::invalid_size:
+					return std::format(
+						"Invalid array size received, expected {:L} but instead got {:L}. This should match the layers'"
+						" height and width and if passing multiple channels also the number of channels.",
+						expected, actual
+					);
+				case validation_errc::invalid_dimension:
+				{
+					constexpr std::array<const char*, 3> ordinals = { "1st", "2nd", "3rd" };
+					constexpr std::array<const char*, 2> roles_2d = { "height", "width" };
+					constexpr std::array<const char*, 3> roles_3d = { "number of channels", "height", "width" };
+					const char* ordinal = dimension < ordinals.size() ? ordinals[dimension] : "nth";
+					if (ndim == 2 && dimension < roles_2d.size())
+					{
+						return std::format(
+							"Invalid {} dimension size encounted, expected {:L} but instead got {:L}."
+							" This number should represent the images' {}",
+							ordinal, expected, actual, roles_2d[dimension]
+						);
+					}
+					if (ndim == 3 && dimension < roles_3d.size())
+					{
+						return std::format(
+							"Invalid {} dimension size encounted, expected {:L} but instead got {:L}."
+							" This number should represent the images' {}",
+							ordinal, expected, actual, roles_3d[dimension]
+						);
+					}
+					return std::format(
+						"Invalid {} dimension size encounted, expected {:L} but instead got {:L}",
+						ordinal, expected, actual
+					);
+				}
+				case validation_errc::unsupported_ndim:
+					return std::format(
+						"Invalid number of array dimensions encountered, expected 1, 2 or 3 but instead got {}", actual
+					);
+				case validation_errc::null_data:
+					return "Python numpy array passed to function resolves to nullptr. If you believe this to be a mistake" \
+						" please open a ticket on the projects' github page.";
+				}
+				return "Unknown validation error";
+			}
+		};
+
+
+		/// Minimal stand-in for C++23's std::expected<T, validation_error>, holding either a value or the validation error
+		/// which prevented its construction. Converts to true if it holds a value.
+		template <typename T>
+		class validation_result
+		{
+		public:
+			validation_result(T value) : m_Value(std::move(value)) {}
+			validation_result(validation_error error) : m_Error(error) { assert(error); }
+
+			bool has_value() const noexcept { return m_Value.has_value(); }
+			explicit operator bool() const noexcept { return has_value(); }
+
+			/// Access the held value.
+			/// 
+			/// \throws py::value_error with the formatted error message if no value is held.
+			T& value() &
+			{
+				throw_if_error();
+				return *m_Value;
+			}
+			const T& value() const&
+			{
+				throw_if_error();
+				return *m_Value;
+			}
+			T&& value() &&
+			{
+				throw_if_error();
+				return std::move(*m_Value);
+			}
+
+			T& operator*() & noexcept { return *m_Value; }
+			const T& operator*() const& noexcept { return *m_Value; }
+			T&& operator*() && noexcept { return std::move(*m_Value); }
+			T* operator->() noexcept { return &*m_Value; }
+			const T* operator->() const noexcept { return &*m_Value; }
+
+			/// The error, only meaningful if has_value() is false.
+			const validation_error& error() const noexcept { return m_Error; }
+
+		private:
+			std::optional<T> m_Value;
+			validation_error m_Error;
+
+			void throw_if_error() const
+			{
+				if (!m_Value)
+				{
+					throw py::value_error(m_Error.message());
+				}
+			}
+		};
+
+
+		/// Non-throwing equivalent of shape_from_py_array. Checks that the array has one of the allowed number of 
+		/// dimensions and holds total_size elements without allocating.
 		///
 		/// \param data The data to extract the shape information from
 		/// \param allowed_dims The number of dimensions that are allowed. Could e.g. be {1, 2} to allow one and two dimensional arrays
-		/// \param total_size The total size of the expected data, if the dimensions do not hold this amount of data we throw a value_error
+		/// \param total_size The total size of the expected data
 		/// 
-		/// \return The shape as a cpp array
+		/// \return A validation_error which is empty if the array is valid
 		template <typename T>
-		std::vector<size_t> shape_from_py_array(const py::array_t<T>& data, const std::vector<size_t> allowed_dims, size_t total_size)
+		validation_error try_check_py_array_dims(const py::array_t<T>& data, std::span<const size_t> allowed_dims, size_t total_size) noexcept
 		{
-			std::vector<size_t> shape;
 			size_t sum = 1;
 			for (py::ssize_t i = 0; i < data.ndim(); ++i)
 			{
-				shape.push_back(data.shape(i));
 				sum *= data.shape(i);
 			}
 
-			// Check that the shape is within the allowed dimensions
-			if (std::find(allowed_dims.begin(), allowed_dims.end(), shape.size()) == allowed_dims.end())
+			const auto ndim = static_cast<size_t>(data.ndim());
+			if (std::find(allowed_dims.begin(), allowed_dims.end(), ndim) == allowed_dims.end())
 			{
-				std::string error_msg = "Invalid number of dimensions received, array must have one of the following number of dimensions: { ";
-				for (size_t i = 0; i < allowed_dims.size() - 1; ++i)
+				validation_error error{ .code = validation_errc::invalid_ndim, .actual = ndim };
+				for (const auto dim : allowed_dims)
 				{
-					error_msg += std::to_string(allowed_dims[i]) + ", ";
+					error.allowed_dims |= dim < 64 ? uint64_t{ 1 } << dim : 0;
 				}
-				error_msg += std::to_string(allowed_dims.back());
-				error_msg += " }. Instead got: " + std::to_string(shape.size());
-				throw py::value_error(error_msg);
+				return error;
 			}
 
 			if (sum != total_size)
 			{
-				throw py::value_error(
-					std::format(
-						"Invalid array size received, expected {:L} but instead got {:L}. This should match the layers'"
-						" height and width and if passing multiple channels also the number of channels.",
-						total_size, sum
-					)
-				);
+				return { .code = validation_errc::invalid_size, .expected = total_size, .actual = sum };
+			}
+			return {};
+		}
+
+		/// Generate a shape array from the py::array_t checking at runtime whether the shape fits into the allowed dims and matches total_size
+		///
+		/// \param data The data to extract the shape information from
+		/// \param allowed_dims The number of dimensions that are allowed. Could e.g. be {1, 2} to allow one and two dimensional arrays
+		/// \param total_size The total size of the expected data, if the dimensions do not hold this amount of data we throw a value_error
+		/// 
+		/// \return The shape as a cpp array
+		template <typename T>
+		std::vector<size_t> shape_from_py_array(const py::array_t<T>& data, const std::vector<size_t> allowed_dims, size_t total_size)
+		{
+			if (auto error = try_check_py_array_dims(data, allowed_dims, total_size))
+			{
+				throw py::value_error(error.message());
+			}
+
+			std::vector<size_t> shape;
+			for (py::ssize_t i = 0; i < data.ndim(); ++i)
+			{
+				shape.push_back(data.shape(i));
 			}
 			return shape;
 		}
@@ -91,6 +273,73 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 			return strides;
 		}
 
+		/// Compare a single dimension of the shape, returning an invalid_dimension error on mismatch
+		inline validation_error try_check_dimension(std::span<const size_t> shape, size_t dimension, size_t expected) noexcept
+		{
+			if (shape[dimension] != expected)
+			{
+				return {
+					.code = validation_errc::invalid_dimension,
+					.dimension = static_cast<uint8_t>(dimension),
+					.ndim = static_cast<uint8_t>(shape.size()),
+					.expected = expected,
+					.actual = shape[dimension]
+				};
+			}
+			return {};
+		}
+
+		/// Non-throwing equivalent of check_shape_1d.
+		inline validation_error try_check_shape_1d(std::span<const size_t> shape, size_t expected_width, size_t expected_height) noexcept
+		{
+			assert(shape.size() == 1);
+			return try_check_dimension(shape, 0, expected_height * expected_width);
+		}
+
+		/// Non-throwing equivalent of check_shape_2d.
+		inline validation_error try_check_shape_2d(std::span<const size_t> shape, size_t expected_width, size_t expected_height) noexcept
+		{
+			assert(shape.size() == 2);
+			if (auto error = try_check_dimension(shape, 0, expected_height))
+			{
+				return error;
+			}
+			return try_check_dimension(shape, 1, expected_width);
+		}
+
+		/// Non-throwing equivalent of check_shape_3d.
+		inline validation_error try_check_shape_3d(std::span<const size_t> shape, size_t expected_channels, size_t expected_width, size_t expected_height) noexcept
+		{
+			assert(shape.size() == 3);
+			if (auto error = try_check_dimension(shape, 0, expected_channels))
+			{
+				return error;
+			}
+			if (auto error = try_check_dimension(shape, 1, expected_height))
+			{
+				return error;
+			}
+			return try_check_dimension(shape, 2, expected_width);
+		}
+
+		/// Non-throwing equivalent of check_shape.
+		inline validation_error try_check_shape(std::span<const size_t> shape, size_t expected_width, size_t expected_height, size_t expected_channels = 1) noexcept
+		{
+			if (shape.size() == 1)
+			{
+				return try_check_shape_1d(shape, expected_width, expected_height);
+			}
+			else if (shape.size() == 2)
+			{
+				return try_check_shape_2d(shape, expected_width, expected_height);
+			}
+			else if (shape.size() == 3)
+			{
+				return try_check_shape_3d(shape, expected_channels, expected_width, expected_height);
+			}
+			return { .code = validation_errc::unsupported_ndim, .actual = shape.size() };
+		}
+
 		/// Validate that a 1D shape vector matches the expected total number of elements (height * width).
 		/// 
 		/// \param shape A shape vector expected to have one dimension.
@@ -99,15 +348,9 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 		/// \throws py::value_error if the shape does not match the expected size.
 		inline void check_shape_1d(std::vector<size_t> shape, size_t expected_width, size_t expected_height)
 		{
-			assert(shape.size() == 1);
-			if (shape[0] != expected_height * expected_width)
+			if (auto error = try_check_shape_1d(shape, expected_width, expected_height))
 			{
-				throw py::value_error(
-					std::format(
-						"Invalid 1st dimension size encounted, expected {:L} but instead got {:L}",
-						expected_height * expected_width, shape[0]
-					)
-				);
+				throw py::value_error(error.message());
 			}
 		}
 
@@ -119,26 +362,9 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 		/// \throws py::value_error if the shape does not match the expected height and width.
 		inline void check_shape_2d(std::vector<size_t> shape, size_t expected_width, size_t expected_height)
 		{
-			assert(shape.size() == 2);
-			if (shape[0] != expected_height)
+			if (auto error = try_check_shape_2d(shape, expected_width, expected_height))
 			{
-				throw py::value_error(
-					std::format(
-						"Invalid 1st dimension size encounted, expected {:L} but instead got {:L}."
-						" This number should represent the images' height",
-						expected_height, shape[0]
-					)
-				);
-			}
-			if (shape[1] != expected_width)
-			{
-				throw py::value_error(
-					std::format(
-						"Invalid 2nd dimension size encounted, expected {:L} but instead got {:L}."
-						" This number should represent the images' width",
-						expected_width, shape[1]
-					)
-				);
+				throw py::value_error(error.message());
 			}
 		}
 
@@ -151,36 +377,9 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 		/// \throws py::value_error if any dimension does not match its expected value.
 		inline void check_shape_3d(std::vector<size_t> shape, size_t expected_channels, size_t expected_width, size_t expected_height)
 		{
-			assert(shape.size() == 3);
-			if (shape[0] != expected_channels)
+			if (auto error = try_check_shape_3d(shape, expected_channels, expected_width, expected_height))
 			{
-				throw py::value_error(
-					std::format(
-						"Invalid 1st dimension size encounted, expected {:L} but instead got {:L}."
-						" This number should represent the images' number of channels",
-						expected_channels, shape[0]
-					)
-				);
-			}
-			if (shape[1] != expected_height)
-			{
-				throw py::value_error(
-					std::format(
-						"Invalid 2nd dimension size encounted, expected {:L} but instead got {:L}."
-						" This number should represent the images' height",
-						expected_height, shape[1]
-					)
-				);
-			}
-			if (shape[2] != expected_width)
-			{
-				throw py::value_error(
-					std::format(
-						"Invalid 3rd dimension size encounted, expected {:L} but instead got {:L}."
-						" This number should represent the images' width",
-						expected_width, shape[2]
-					)
-				);
+				throw py::value_error(error.message());
 			}
 		}
 
@@ -193,26 +392,64 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 		/// \throws py::value_error if shape does not conform to expected dimensions or sizes.
 		inline void check_shape(std::vector<size_t> shape, size_t expected_width, size_t expected_height, size_t expected_channels = 1)
 		{
-			if (shape.size() == 1)
-			{
-				check_shape_1d(shape, expected_width, expected_height);
-			}
-			else if (shape.size() == 2)
+			if (auto error = try_check_shape(shape, expected_width, expected_height, expected_channels))
 			{
-				check_shape_2d(shape, expected_width, expected_height);
+				throw py::value_error(error.message());
 			}
-			else if (shape.size() == 3)
-			{
-				check_shape_3d(shape, expected_channels, expected_width, expected_height);
-			}
-			else
+		}
+
+		/// Validate that the Python array has exactly the given shape, both in its number of dimensions and in the
+		/// size of each dimension. Used for the compile-time typed images where the rank is known up front.
+		/// 
+		/// \tparam T The data type stored in the array.
+		/// \tparam N The number of dimensions expected.
+		/// \param data The Python array to check.
+		/// \param expected_shape The shape the array must have.
+		/// \throws py::value_error if the rank or any dimension does not match.
+		template <typename T, size_t N>
+		void check_shape_exact(const py::array_t<T>& data, const std::array<size_t, N>& expected_shape)
+		{
+			if (static_cast<size_t>(data.ndim()) != N)
 			{
 				throw py::value_error(
 					std::format(
-						"Invalid number of array dimensions encountered, expected 1, 2 or 3 but instead got {}", shape.size()
+						"Invalid number of dimensions received, expected {} but instead got {}", N, data.ndim()
 					)
 				);
 			}
+			for (size_t i = 0; i < N; ++i)
+			{
+				if (static_cast<size_t>(data.shape(i)) != expected_shape[i])
+				{
+					throw py::value_error(
+						std::format(
+							"Invalid size for dimension {} encountered, expected {:L} but instead got {:L}",
+							i, expected_shape[i], data.shape(i)
+						)
+					);
+				}
+			}
+		}
+
+		/// Check whether the provided Python array is C-contiguous in memory.
+		/// 
+		/// \tparam T The data type stored in the array.
+		/// \param data The Python array to check.
+		template <typename T>
+		bool is_c_style_contiguous(const py::array_t<T>& data)
+		{
+			return py::detail::npy_api::constants::NPY_ARRAY_C_CONTIGUOUS_ == (data.flags() & py::detail::npy_api::constants::NPY_ARRAY_C_CONTIGUOUS_);
+		}
+
+		/// Check whether the provided Python array is Fortran-contiguous (column-major) in memory. Note that 
+		/// one-dimensional contiguous arrays are both C- and Fortran-contiguous.
+		/// 
+		/// \tparam T The data type stored in the array.
+		/// \param data The Python array to check.
+		template <typename T>
+		bool is_f_style_contiguous(const py::array_t<T>& data)
+		{
+			return py::detail::npy_api::constants::NPY_ARRAY_F_CONTIGUOUS_ == (data.flags() & py::detail::npy_api::constants::NPY_ARRAY_F_CONTIGUOUS_);
 		}
 
 		/// Ensure the provided Python array is C-contiguous in memory. If not, convert it in-place.
@@ -222,12 +459,24 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 		template <typename T>
 		void check_c_style_contiguous(py::array_t<T>& data)
 		{
-			if (py::detail::npy_api::constants::NPY_ARRAY_C_CONTIGUOUS_ != (data.flags() & py::detail::npy_api::constants::NPY_ARRAY_C_CONTIGUOUS_))
+			if (!is_c_style_contiguous(data))
 			{
+				PY_IMG_UTIL_TRACE_SCOPE("forcecast", data);
 				data = data.template cast<py::array_t<T, py::array::c_style | py::array::forcecast>>();
 			}
 		}
 
+		/// Non-throwing equivalent of check_not_null.
+		template <typename T>
+		validation_error try_check_not_null(const py::array_t<T>& data) noexcept
+		{
+			if (data.data() == nullptr)
+			{
+				return { .code = validation_errc::null_data };
+			}
+			return {};
+		}
+
 		/// Validate that the given Python array is not null.
 		/// 
 		/// \tparam T The data type stored in the array.
@@ -236,12 +485,9 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 		template <typename T>
 		void check_not_null(const py::array_t<T>& data)
 		{
-			if (data.data() == nullptr)
+			if (auto error = try_check_not_null(data))
 			{
-				throw py::value_error(
-					"Python numpy array passed to function resolves to nullptr. If you believe this to be a mistake" \
-					" please open a ticket on the projects' github page."
-				);
+				throw py::value_error(error.message());
 			}
 		}
 
@@ -291,7 +537,134 @@ namespace NAMESPACE_PY_IMAGE_UTIL
 			std::span<const T> data_span(data.data(), data.size());
 			check_cpp_span_matches_shape(data_span, shape);
 		}
+
+		/// Validate that a C++ span with padded rows can hold an image of the given width and height.
+		/// 
+		/// \tparam T The data type of the span.
+		/// \param data The C++ span to check.
+		/// \param width The width of the image in number of elements.
+		/// \param height The height of the image in number of elements.
+		/// \param pitch The distance between the start of two rows.
+		/// \throws py::value_error if the pitch is not a multiple of sizeof(T), is smaller than a row or the span is too small.
+		template <typename T>
+		void check_cpp_span_matches_pitch(const std::span<const T> data, size_t width, size_t height, row_pitch pitch)
+		{
+			if (pitch.bytes % sizeof(T) != 0)
+			{
+				throw py::value_error(
+					std::format(
+						"Invalid row pitch received, {:L} bytes is not a multiple of the element size {}", pitch.bytes, sizeof(T)
+					)
+				);
+			}
+			if (pitch.bytes < width * sizeof(T))
+			{
+				throw py::value_error(
+					std::format(
+						"Invalid row pitch received, {:L} bytes is smaller than a single row of {:L} bytes", pitch.bytes, width * sizeof(T)
+					)
+				);
+			}
+
+			// The last row does not have to be padded
+			const size_t required_size = height == 0 ? 0 : (height - 1) * pitch.elements<T>() + width;
+			if (data.size() < required_size)
+			{
+				throw py::value_error(
+					std::format(
+						"Invalid buffer size received, expected at least {:L} elements for {:L} rows with a pitch of {:L} bytes"
+						" but instead got {:L}",
+						required_size, height, pitch.bytes, data.size()
+					)
+				);
+			}
+		}
+
+		/// Validate that a region of interest lies within the bounds of a 2D [height, width] or 3D interleaved 
+		/// [height, width, channels] target array.
+		/// 
+		/// \param target The python array to paste into
+		/// \param x The column of the top left corner of the region
+		/// \param y The row of the top left corner of the region
+		/// \param width The width of the region
+		/// \param height The height of the region
+		/// \throws py::value_error if the array has the wrong number of dimensions, is read-only or the region is out of bounds
+		template <typename T>
+		void check_roi_in_bounds(const py::array_t<T>& target, size_t x, size_t y, size_t width, size_t height)
+		{
+			if (target.ndim() != 2 && target.ndim() != 3)
+			{
+				throw py::value_error(
+					std::format(
+						"Invalid target array received, expected a 2D [height, width] or 3D [height, width, channels] array but instead got {} dimensions", 
+						target.ndim()
+					)
+				);
+			}
+			if (!target.writeable())
+			{
+				throw py::value_error("Unable to paste into a read-only numpy array");
+			}
+
+			const auto target_height = static_cast<size_t>(target.shape(0));
+			const auto target_width = static_cast<size_t>(target.shape(1));
+			if (x > target_width || width > target_width - x || y > target_height || height > target_height - y)
+			{
+				throw py::value_error(
+					std::format(
+						"Invalid region received, the region [x: {:L}, y: {:L}, width: {:L}, height: {:L}] exceeds the target array of shape [{:L}, {:L}]",
+						x, y, width, height, target_height, target_width
+					)
+				);
+			}
+		}
+
+		/// Validate that the padded C++ buffer matches the image according to the given validation policy.
+		template <validation_policy Policy, typename T>
+		void validate_cpp_span_matches_pitch([[maybe_unused]] const std::span<const T> data, [[maybe_unused]] size_t width, [[maybe_unused]] size_t height, [[maybe_unused]] row_pitch pitch)
+		{
+			if constexpr (std::is_same_v<Policy, policy::checked>)
+			{
+				check_cpp_span_matches_pitch(data, width, height, pitch);
+			}
+			else if constexpr (std::is_same_v<Policy, policy::debug>)
+			{
+				assert(pitch.bytes % sizeof(T) == 0 && pitch.bytes >= width * sizeof(T));
+				assert(height == 0 || data.size() >= (height - 1) * pitch.elements<T>() + width);
+			}
+		}
+
+		/// Validate that the size of a C++ buffer matches the shape according to the given validation policy.
+		/// 
+		/// \tparam Policy The validation policy, see policy.h
+		/// \param data The C++ span to check.
+		/// \param shape The shape vector whose product must equal the span's size.
+		/// \throws py::value_error if the policy is policy::checked and the span size does not match the shape's product.
+		template <validation_policy Policy, typename T>
+		void validate_cpp_span_matches_shape([[maybe_unused]] const std::span<const T> data, [[maybe_unused]] const std::vector<size_t>& shape)
+		{
+			if constexpr (std::is_same_v<Policy, policy::checked>)
+			{
+				check_cpp_span_matches_shape(data, shape);
+			}
+			else if constexpr (std::is_same_v<Policy, policy::debug>)
+			{
+				assert(!shape.empty());
+				assert(std::accumulate(shape.begin(), shape.end(), size_t{ 1 }, std::multiplies<size_t>()) == data.size());
+			}
+		}
 	
 	} // detail
 
+
+	/// Error code describing why a non-throwing conversion (try_from_py_array) failed
+	using validation_errc = detail::validation_errc;
+
+	/// The error returned by a failed non-throwing conversion, its message is only formatted on request
+	using validation_error = detail::validation_error;
+
+	/// Result of a non-throwing conversion holding either the converted value or the validation_error
+	template <typename T>
+	using validation_result = detail::validation_result<T>;
+
 } // NAMESPACE_PY_IMAGE_UTIL
\ No newline at end of file
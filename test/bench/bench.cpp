@@ -0,0 +1,271 @@
+// Opt-in micro benchmarks for the conversion kernels, configure with -DPY_IMAGE_UTIL_BUILD_BENCHMARKS=ON and run
+//
+//     py_img_util_bench [copy] [cache] [transpose] [threads]
+//
+// to run the given sections (all of them if none are given). Numbers are printed as a table, there is no pass/fail.
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <format>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+
+#include "py_img_util/copy.h"
+#include "py_img_util/detail.h"
+#include "py_img_util/executor.h"
+#include "py_img_util/image.h"
+
+namespace py = pybind11;
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+namespace
+{
+	using bench_clock = std::chrono::steady_clock;
+
+	constexpr size_t mib = 1024 * 1024;
+
+	/// The fastest of `repetitions` runs of fn in seconds, after one untimed warm-up run
+	template <typename Fn>
+	double best_seconds(size_t repetitions, Fn&& fn)
+	{
+		fn();
+		double best = std::numeric_limits<double>::max();
+		for (size_t i = 0; i < repetitions; ++i)
+		{
+			const auto start = bench_clock::now();
+			fn();
+			best = std::min(best, std::chrono::duration<double>(bench_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	double gb_per_second(size_t bytes, double seconds)
+	{
+		return static_cast<double>(bytes) / seconds / 1e9;
+	}
+
+	/// Keeps the compiler from optimizing away the result of a benchmarked computation
+	template <typename T>
+	void do_not_optimize(const T& value)
+	{
+		static std::atomic<T> sink;
+		sink.store(value, std::memory_order_relaxed);
+	}
+
+
+	/// Raw throughput of memcpy against the non-temporal stream_copy for buffers below, around and well beyond the
+	/// size of a typical last level cache
+	void bench_copy()
+	{
+		std::puts(std::format("{:>12} {:>14} {:>14}", "size", "memcpy GB/s", "stream GB/s").c_str());
+		for (const size_t bytes : { 1 * mib, 16 * mib, 64 * mib, 256 * mib })
+		{
+			std::vector<std::byte> src(bytes, std::byte{ 1 });
+			std::vector<std::byte> dst(bytes, std::byte{ 0 });
+			const size_t repetitions = std::max<size_t>(3, 1024 * mib / bytes);
+
+			const double memcpy_seconds = best_seconds(repetitions, [&]() { std::memcpy(dst.data(), src.data(), bytes); });
+			const double stream_seconds = best_seconds(repetitions, [&]() { detail::stream_copy(dst.data(), src.data(), bytes); });
+			std::puts(std::format("{:>9} MiB {:>14.2f} {:>14.2f}", bytes / mib, gb_per_second(bytes, memcpy_seconds), gb_per_second(bytes, stream_seconds)).c_str());
+		}
+	}
+
+
+	/// Throughput of a cache resident workload on a second thread while the main thread copies a large buffer,
+	/// this is what streaming stores are meant to protect
+	void bench_cache_impact()
+	{
+		constexpr size_t workload_bytes = 2 * mib;
+		constexpr size_t copy_bytes = 256 * mib;
+		constexpr auto duration = std::chrono::milliseconds(1000);
+
+		std::vector<std::byte> src(copy_bytes, std::byte{ 1 });
+		std::vector<std::byte> dst(copy_bytes, std::byte{ 0 });
+
+		// Measure how many passes over its working set the workload manages while `copy` runs repeatedly
+		auto passes_per_second = [&](const std::function<void()>& copy)
+			{
+				std::vector<uint64_t> working_set(workload_bytes / sizeof(uint64_t), 1);
+				std::atomic<bool> stop = false;
+				std::atomic<size_t> passes = 0;
+				std::thread workload([&]()
+					{
+						while (!stop.load(std::memory_order_relaxed))
+						{
+							do_not_optimize(std::accumulate(working_set.begin(), working_set.end(), uint64_t{ 0 }));
+							passes.fetch_add(1, std::memory_order_relaxed);
+						}
+					});
+
+				const auto start = bench_clock::now();
+				while (bench_clock::now() - start < duration)
+				{
+					if (copy)
+					{
+						copy();
+					}
+					else
+					{
+						std::this_thread::sleep_for(std::chrono::milliseconds(10));
+					}
+				}
+				stop.store(true);
+				workload.join();
+				return static_cast<double>(passes.load()) / std::chrono::duration<double>(bench_clock::now() - start).count();
+			};
+
+		const double baseline = passes_per_second({});
+		const double with_memcpy = passes_per_second([&]() { std::memcpy(dst.data(), src.data(), copy_bytes); });
+		const double with_stream = passes_per_second([&]() { detail::stream_copy(dst.data(), src.data(), copy_bytes); });
+
+		std::puts(std::format("{} MiB workload alongside {} MiB copies", workload_bytes / mib, copy_bytes / mib).c_str());
+		std::puts(std::format("{:>16} {:>14} {:>10}", "concurrent copy", "passes/s", "relative").c_str());
+		std::puts(std::format("{:>16} {:>14.0f} {:>9.0f}%", "none", baseline, 100.0).c_str());
+		std::puts(std::format("{:>16} {:>14.0f} {:>9.0f}%", "memcpy", with_memcpy, 100.0 * with_memcpy / baseline).c_str());
+		std::puts(std::format("{:>16} {:>14.0f} {:>9.0f}%", "stream_copy", with_stream, 100.0 * with_stream / baseline).c_str());
+	}
+
+
+	/// The tiled transpose used for Fortran-ordered input against a naive loop, serially and in parallel
+	void bench_transpose()
+	{
+		constexpr size_t rows = 4096;
+		constexpr size_t cols = 4096;
+		constexpr size_t bytes = rows * cols * sizeof(float);
+		std::vector<float> src(rows * cols);
+		std::iota(src.begin(), src.end(), 0.0f);
+		std::vector<float> dst(rows * cols);
+
+		const double naive_seconds = best_seconds(5, [&]()
+			{
+				for (size_t y = 0; y < rows; ++y)
+				{
+					for (size_t x = 0; x < cols; ++x)
+					{
+						dst[x * rows + y] = src[y * cols + x];
+					}
+				}
+			});
+		double blocked_serial_seconds = 0.0;
+		{
+			inline_executor serial;
+			scoped_executor guard(serial);
+			blocked_serial_seconds = best_seconds(5, [&]() { detail::transpose_blocked(src.data(), dst.data(), rows, cols); });
+		}
+		const double blocked_parallel_seconds = best_seconds(5, [&]() { detail::transpose_blocked(src.data(), dst.data(), rows, cols); });
+
+		std::puts(std::format("{}x{} float transpose", rows, cols).c_str());
+		std::puts(std::format("{:>20} {:>10}", "variant", "GB/s").c_str());
+		std::puts(std::format("{:>20} {:>10.2f}", "naive", gb_per_second(bytes, naive_seconds)).c_str());
+		std::puts(std::format("{:>20} {:>10.2f}", "blocked, serial", gb_per_second(bytes, blocked_serial_seconds)).c_str());
+		std::puts(std::format("{:>20} {:>10.2f}", "blocked, parallel", gb_per_second(bytes, blocked_parallel_seconds)).c_str());
+	}
+
+
+	/// Throughput of from_py_array(tag::vector{}, ...) converting a shared array from 1..N threads, each thread only
+	/// holds the GIL for the duration of a conversion which in turn releases it around the copy or transpose.
+	void bench_threads()
+	{
+		constexpr size_t width = 2048;
+		constexpr size_t height = 2048;
+		constexpr size_t conversions_per_thread = 16;
+		const size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+		py::scoped_interpreter interpreter;
+		std::vector<float> buffer(width * height);
+		std::iota(buffer.begin(), buffer.end(), 0.0f);
+		py::array_t<float> arr({ height, width }, buffer.data());
+		py::array_t<float> transposed = arr.attr("T").cast<py::array_t<float>>();
+
+		// Conversions per second of `num_threads` threads each converting `source` conversions_per_thread times
+		auto conversions_per_second = [&](const py::array_t<float>& source, size_t source_width, size_t source_height, size_t num_threads)
+			{
+				auto worker = [&]()
+					{
+						// Keep each conversion on its own thread rather than nesting a parallel_for across all cores
+						inline_executor serial;
+						scoped_executor guard(serial);
+						std::vector<float> out;
+						for (size_t i = 0; i < conversions_per_thread; ++i)
+						{
+							py::gil_scoped_acquire acquire;
+							from_py_array(tag::vector{}, source, source_width, source_height, out);
+						}
+					};
+
+				py::gil_scoped_release release;
+				const auto start = bench_clock::now();
+				std::vector<std::thread> threads;
+				for (size_t i = 0; i < num_threads; ++i)
+				{
+					threads.emplace_back(worker);
+				}
+				for (auto& thread : threads)
+				{
+					thread.join();
+				}
+				const double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+				return static_cast<double>(num_threads * conversions_per_thread) / seconds;
+			};
+
+		std::puts(std::format("{}x{} float conversions, {} per thread", width, height, conversions_per_thread).c_str());
+		std::puts(std::format("{:>8} {:>16} {:>10} {:>16} {:>10}", "threads", "contiguous /s", "speedup", "transposed /s", "speedup").c_str());
+		double contiguous_baseline = 0.0;
+		double transposed_baseline = 0.0;
+		for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+		{
+			const double contiguous = conversions_per_second(arr, width, height, num_threads);
+			const double transpose = conversions_per_second(transposed, height, width, num_threads);
+			if (num_threads == 1)
+			{
+				contiguous_baseline = contiguous;
+				transposed_baseline = transpose;
+			}
+			std::puts(std::format("{:>8} {:>16.1f} {:>9.2f}x {:>16.1f} {:>9.2f}x", num_threads, contiguous, contiguous / contiguous_baseline, transpose, transpose / transposed_baseline).c_str());
+		}
+	}
+
+	struct section
+	{
+		std::string_view name;
+		void(*run)();
+	};
+
+	constexpr section sections[] = {
+		{ "copy", &bench_copy },
+		{ "cache", &bench_cache_impact },
+		{ "transpose", &bench_transpose },
+		{ "threads", &bench_threads },
+	};
+}
+
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string_view> selected(argv + 1, argv + argc);
+	for (const auto& section : sections)
+	{
+		if (!selected.empty() && std::find(selected.begin(), selected.end(), section.name) == selected.end())
+		{
+			continue;
+		}
+		std::puts(std::format("== {} ==", section.name).c_str());
+		section.run();
+		std::puts("");
+	}
+	return 0;
+}
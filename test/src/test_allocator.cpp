@@ -0,0 +1,61 @@
+#include "doctest.h"
+
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <cstdint>
+
+#include "py_img_util/allocator.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("huge_page_allocator maps large buffers 2MiB aligned")
+{
+    const size_t previous = huge_page_threshold();
+    set_huge_page_threshold(4 * 1024 * 1024);
+    {
+        huge_vector<float> data(2 * 1024 * 1024);
+        CHECK(data.get_allocator().uses_huge_pages(data.capacity() * sizeof(float)));
+#if defined(__linux__)
+        CHECK(reinterpret_cast<uintptr_t>(data.data()) % detail::huge_page_size == 0);
+#endif
+        std::iota(data.begin(), data.end(), 0.0f);
+        CHECK(data.back() == static_cast<float>(data.size() - 1));
+
+        // Growing beyond the mapping must move the data
+        data.resize(data.size() * 2);
+        CHECK(data[1234] == 1234.0f);
+    }
+    set_huge_page_threshold(previous);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("huge_page_allocator uses regular allocations below the threshold")
+{
+    huge_vector<uint8_t> data(1024, uint8_t{ 7 });
+    CHECK_FALSE(data.get_allocator().uses_huge_pages(data.size()));
+    CHECK(data[1023] == 7);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("huge_page_allocator captures the threshold on construction")
+{
+    const size_t previous = huge_page_threshold();
+    set_huge_page_threshold(std::numeric_limits<size_t>::max());
+    huge_page_allocator<float> disabled;
+    set_huge_page_threshold(1024);
+    huge_page_allocator<float> enabled;
+
+    CHECK_FALSE(disabled.uses_huge_pages(1 << 30));
+    CHECK(enabled.uses_huge_pages(1 << 30));
+    CHECK_FALSE(disabled == enabled);
+    CHECK(huge_page_allocator<double>(enabled) == enabled);
+    set_huge_page_threshold(previous);
+}
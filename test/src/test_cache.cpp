@@ -0,0 +1,151 @@
+#include "doctest.h"
+
+#include <vector>
+#include <span>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+
+#include "py_img_util/cache.h"
+#include "py_img_util/image.h"
+
+#include "test_utils.h"
+
+namespace py = pybind11;
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("copy_and_hash matches hash_bytes and copies the data")
+{
+    std::vector<uint8_t> src(40000);
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = static_cast<uint8_t>(i * 7);
+    }
+    std::vector<uint8_t> dst(src.size());
+
+    auto hash = detail::copy_and_hash(
+        reinterpret_cast<std::byte*>(dst.data()),
+        reinterpret_cast<const std::byte*>(src.data()),
+        src.size()
+    );
+    CHECK(dst == src);
+    CHECK(hash == detail::hash_bytes(reinterpret_cast<const std::byte*>(src.data()), src.size()));
+
+    src[src.size() - 1] += 1;
+    CHECK(hash != detail::hash_bytes(reinterpret_cast<const std::byte*>(src.data()), src.size()));
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("conversion_cache returns the same buffer for repeated conversions")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+
+            conversion_cache cache;
+            auto first = from_py_array(tag::cached{}, arr, 3, 2, cache);
+            auto second = from_py_array(tag::cached{}, arr, 3, 2, cache);
+
+            CHECK(*first == buffer);
+            CHECK(first.get() == second.get());
+            CHECK(cache.size() == 1);
+            CHECK(cache.hits() == 1);
+            CHECK(cache.misses() == 1);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("conversion_cache still validates the shape on a cache hit")
+{
+    test_utils::with_python([]()
+        {
+            py::array_t<float> arr({ 2, 3 });
+
+            conversion_cache cache;
+            from_py_array(tag::cached{}, arr, 3, 2, cache);
+            CHECK_THROWS_AS(from_py_array(tag::cached{}, arr, 2, 3, cache), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("conversion_cache drops entries once the python array dies")
+{
+    test_utils::with_python([]()
+        {
+            conversion_cache cache;
+            std::shared_ptr<const std::vector<float>> converted;
+            {
+                py::array_t<float> arr({ 4, 4 });
+                converted = from_py_array(tag::cached{}, arr, 4, 4, cache);
+                CHECK(cache.size() == 1);
+            }
+            CHECK(cache.size() == 0);
+            CHECK(cache.bytes() == 0);
+            // The buffer itself stays valid for as long as the caller holds on to it
+            CHECK(converted->size() == 16);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("conversion_cache evicts least recently used entries beyond the byte budget")
+{
+    test_utils::with_python([]()
+        {
+            conversion_cache cache({ .byte_budget = 2 * 16 * sizeof(double) });
+            py::array_t<double> a({ 4, 4 });
+            py::array_t<double> b({ 4, 4 });
+            py::array_t<double> c({ 4, 4 });
+
+            from_py_array(tag::cached{}, a, 4, 4, cache);
+            from_py_array(tag::cached{}, b, 4, 4, cache);
+            // Touch a so that b becomes the least recently used entry
+            from_py_array(tag::cached{}, a, 4, 4, cache);
+            from_py_array(tag::cached{}, c, 4, 4, cache);
+
+            CHECK(cache.size() == 2);
+            CHECK(cache.bytes() == 2 * 16 * sizeof(double));
+
+            auto hits = cache.hits();
+            from_py_array(tag::cached{}, a, 4, 4, cache);
+            CHECK(cache.hits() == hits + 1);
+            from_py_array(tag::cached{}, b, 4, 4, cache);
+            CHECK(cache.hits() == hits + 1);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("conversion_cache with verify_content detects in-place modification")
+{
+    test_utils::with_python([]()
+        {
+            py::array_t<int> arr({ 2, 2 });
+            arr.mutable_at(0, 0) = 1;
+            arr.mutable_at(0, 1) = 2;
+            arr.mutable_at(1, 0) = 3;
+            arr.mutable_at(1, 1) = 4;
+
+            conversion_cache cache({ .verify_content = true });
+            auto first = from_py_array(tag::cached{}, arr, 2, 2, cache);
+            arr.mutable_at(1, 1) = 42;
+            auto second = from_py_array(tag::cached{}, arr, 2, 2, cache);
+
+            CHECK(first.get() != second.get());
+            CHECK((*first)[3] == 4);
+            CHECK((*second)[3] == 42);
+            CHECK(cache.size() == 1);
+        });
+}
@@ -0,0 +1,58 @@
+#include "doctest.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+#include "py_img_util/copy.h"
+#include "py_img_util/parallel.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("stream_copy copies unaligned buffers of any size")
+{
+    std::vector<uint8_t> src(5000);
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    for (size_t offset : { 0, 1, 13, 31, 63 })
+    {
+        for (size_t size : { 0, 1, 15, 64, 127, 256, 1000, 4000 })
+        {
+            std::vector<uint8_t> dst(src.size() + 64, 0);
+            detail::stream_copy(dst.data() + offset, src.data() + 1, size);
+            CHECK(std::equal(src.begin() + 1, src.begin() + 1 + size, dst.begin() + offset));
+            // Bytes around the destination region must remain untouched
+            CHECK(std::all_of(dst.begin(), dst.begin() + offset, [](uint8_t v) { return v == 0; }));
+            CHECK(std::all_of(dst.begin() + offset + size, dst.end(), [](uint8_t v) { return v == 0; }));
+        }
+    }
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("parallel_copy produces identical results with and without streaming stores")
+{
+    const size_t previous = streaming_copy_threshold();
+    std::vector<float> src(1 << 20);
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = static_cast<float>(i);
+    }
+
+    for (size_t threshold : { size_t{ 0 }, std::numeric_limits<size_t>::max() })
+    {
+        set_streaming_copy_threshold(threshold);
+        std::vector<float> dst(src.size());
+        detail::parallel_copy(src.data(), dst.data(), src.size());
+        CHECK(dst == src);
+    }
+    set_streaming_copy_threshold(previous);
+}
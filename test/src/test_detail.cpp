@@ -219,4 +219,72 @@ TEST_CASE("to_py::from_view creates correct NumPy array from span")
             CHECK(ptr[2] == doctest::Approx(2.5f));
             CHECK(ptr[5] == doctest::Approx(5.5f));
         });
-}
\ No newline at end of file
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("transpose_blocked transposes non-square matrices spanning multiple tiles")
+{
+    const size_t rows = 70;
+    const size_t cols = 45;
+    std::vector<int> src(rows * cols);
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = static_cast<int>(i);
+    }
+    std::vector<int> dst(src.size());
+    transpose_blocked(src.data(), dst.data(), rows, cols);
+
+    for (size_t r = 0; r < rows; ++r)
+    {
+        for (size_t c = 0; c < cols; ++c)
+        {
+            CHECK(dst[c * rows + r] == src[r * cols + c]);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py::vector converts Fortran-ordered input without modifying it")
+{
+    test_utils::with_python([]()
+        {
+            // Create a 3×5 array and transpose it to get a Fortran-ordered 5×3 array
+            py::array_t<float> base({ 3, 5 });
+            for (py::ssize_t i = 0; i < 3; ++i)
+            {
+                for (py::ssize_t j = 0; j < 5; ++j)
+                {
+                    base.mutable_at(i, j) = static_cast<float>(i * 5 + j);
+                }
+            }
+            py::array_t<float> transposed = base.attr("T").cast<py::array_t<float>>();
+            REQUIRE(is_f_style_contiguous(transposed));
+            REQUIRE_FALSE(is_c_style_contiguous(transposed));
+
+            auto vec = from_py::vector<float>(transposed, 3, 5);
+            REQUIRE(vec.size() == 15);
+            for (size_t y = 0; y < 5; ++y)
+            {
+                for (size_t x = 0; x < 3; ++x)
+                {
+                    CHECK(vec[y * 3 + x] == static_cast<float>(x * 5 + y));
+                }
+            }
+            // The transpose path reads the source directly instead of replacing it with a forcecast copy
+            CHECK_FALSE(is_c_style_contiguous(transposed));
+        });
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py::vector validates the shape of Fortran-ordered input")
+{
+    test_utils::with_python([]()
+        {
+            py::array_t<float> base({ 3, 5 });
+            py::array_t<float> transposed = base.attr("T").cast<py::array_t<float>>();
+            CHECK_THROWS_AS(from_py::vector<float>(transposed, 5, 3), py::value_error);
+        });
+}
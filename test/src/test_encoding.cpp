@@ -0,0 +1,128 @@
+#include "doctest.h"
+
+#include <vector>
+#include <cstdint>
+#include <span>
+#include <numeric>
+
+#include "py_img_util/encoding.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("packbits_encode produces repeat and literal packets")
+{
+    const std::vector<uint8_t> src = { 1, 2, 7, 7, 7, 7, 3 };
+    std::vector<uint8_t> dst(detail::packbits_max_size(src.size()));
+    const size_t size = detail::packbits_encode(src, dst.data());
+    dst.resize(size);
+    CHECK(dst == std::vector<uint8_t>{ 1, 1, 2, 253, 7, 0, 3 });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("packbits_encode and packbits_decode round-trip")
+{
+    for (size_t size : { 0, 1, 2, 127, 128, 129, 300, 1000 })
+    {
+        std::vector<uint8_t> src(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            // Mix of long runs and noise
+            src[i] = (i / 150) % 2 == 0 ? static_cast<uint8_t>(i * 31 + 7) : 42;
+        }
+        std::vector<uint8_t> encoded(detail::packbits_max_size(size));
+        encoded.resize(detail::packbits_encode(src, encoded.data()));
+
+        std::vector<uint8_t> decoded(size);
+        CHECK(detail::packbits_decode(encoded, decoded.data(), decoded.size()));
+        CHECK(decoded == src);
+    }
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("packbits_encode_image encodes rows independently in big-endian order")
+{
+    const size_t width = 70;
+    const size_t height = 257;
+    std::vector<uint16_t> src(width * height);
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = (i / width) % 3 == 0 ? 0x0707 : static_cast<uint16_t>(i);
+    }
+
+    const auto encoded = detail::packbits_encode_image(src.data(), width, height);
+    CHECK(encoded.row_offsets.size() == height + 1);
+    CHECK(encoded.row_offsets.back() == encoded.data.size());
+    CHECK(encoded.row_size(0) < width * sizeof(uint16_t));
+
+    std::vector<uint8_t> row(width * sizeof(uint16_t));
+    for (size_t y = 0; y < height; ++y)
+    {
+        REQUIRE(detail::packbits_decode(encoded.row(y), row.data(), row.size()));
+        for (size_t x = 0; x < width; ++x)
+        {
+            const uint16_t value = static_cast<uint16_t>((row[2 * x] << 8) | row[2 * x + 1]);
+            CHECK(value == src[y * width + x]);
+        }
+    }
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("packbits_encode_bands only keeps the encoded bytes of each band alive")
+{
+    const size_t width = 512;
+    const size_t height = 512;
+    std::vector<uint16_t> src(width * height, 0x0101);
+    std::vector<size_t> row_sizes(height + 1, 0);
+
+    const auto bands = detail::packbits_encode_bands(src.data(), width, height, std::span<size_t>(row_sizes));
+    size_t encoded_size = 0;
+    size_t band_capacity = 0;
+    for (const auto& band : bands)
+    {
+        encoded_size += band.size();
+        band_capacity += band.capacity();
+    }
+    CHECK(encoded_size == std::accumulate(row_sizes.begin(), row_sizes.end(), size_t{ 0 }));
+    CHECK(band_capacity < 2 * encoded_size);
+    CHECK(band_capacity * 32 < src.size() * sizeof(uint16_t));
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("delta_encode_image predicts from the left neighbour with wrapping")
+{
+    const std::vector<uint8_t> src = { 10, 12, 5, 5, 1, 2, 3, 4 };
+    const auto encoded = detail::delta_encode_image(src.data(), 4, 2);
+    CHECK(encoded.data == std::vector<uint8_t>{ 10, 2, 249, 0, 1, 1, 1, 1 });
+    CHECK(encoded.row_size(1) == 4);
+
+    const std::vector<uint16_t> wide = { 0x0100, 0x0101 };
+    const auto encoded_wide = detail::delta_encode_image(wide.data(), 2, 1);
+    CHECK(encoded_wide.data == std::vector<uint8_t>{ 0x01, 0x00, 0x00, 0x01 });
+}
+
+
+template <typename T>
+concept delta_encodable = requires(const T* src) { detail::delta_encode_image(src, size_t{ 1 }, size_t{ 1 }); };
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("delta_encode_image rejects bool through its constraint")
+{
+    static_assert(delta_encodable<uint8_t>);
+    static_assert(delta_encodable<int32_t>);
+    static_assert(!delta_encodable<bool>);
+    static_assert(!delta_encodable<float>);
+    CHECK_FALSE(is_delta_encodable_v<bool>);
+}
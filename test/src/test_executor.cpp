@@ -0,0 +1,107 @@
+#include "doctest.h"
+
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#include "py_img_util/executor.h"
+#include "py_img_util/parallel.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("thread_pool_executor runs every chunk exactly once")
+{
+    thread_pool_executor pool(4);
+    CHECK(pool.concurrency() == 4);
+
+    std::vector<std::atomic<int>> visited(1000);
+    auto fn = [&](size_t chunk) { visited[chunk].fetch_add(1); };
+    for (size_t i = 0; i < 20; ++i)
+    {
+        pool.bulk_execute(visited.size(), fn);
+    }
+    for (const auto& count : visited)
+    {
+        CHECK(count.load() == 20);
+    }
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("thread_pool_executor supports concurrent and nested submission")
+{
+    thread_pool_executor pool(3);
+    std::atomic<size_t> total = 0;
+    auto inner = [&](size_t) { total.fetch_add(1); };
+    auto outer = [&](size_t) { pool.bulk_execute(8, inner); };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&]() { pool.bulk_execute(8, outer); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    CHECK(total.load() == 4 * 8 * 8);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("scoped_executor routes parallel_for through the given executor")
+{
+    inline_executor serial;
+    scoped_executor guard(serial);
+    CHECK(&current_executor() == &serial);
+
+    const auto caller = std::this_thread::get_id();
+    size_t calls = 0;
+    detail::parallel_for(1000, 1, [&](size_t begin, size_t end)
+        {
+            CHECK(begin == 0);
+            CHECK(end == 1000);
+            CHECK(std::this_thread::get_id() == caller);
+            ++calls;
+        });
+    CHECK(calls == 1);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("set_default_executor installs a custom scheduler")
+{
+    std::atomic<size_t> submissions = 0;
+    callback_executor custom([&](size_t num_chunks, chunk_function fn)
+        {
+            submissions.fetch_add(1);
+            for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+            {
+                fn(chunk);
+            }
+        }, 4);
+
+    set_default_executor(&custom);
+    std::vector<int> visited(1000, 0);
+    detail::parallel_for(visited.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                visited[i] += 1;
+            }
+        });
+    set_default_executor(nullptr);
+
+    CHECK(submissions.load() == 1);
+    CHECK(&current_executor() == &builtin_executor());
+    for (const auto count : visited)
+    {
+        CHECK(count == 1);
+    }
+}
@@ -0,0 +1,168 @@
+#include "doctest.h"
+
+#include <vector>
+#include <thread>
+#include <numeric>
+#include <optional>
+
+#include "test_utils.h"
+#include "py_img_util/frame_channel.h"
+
+namespace py = pybind11;
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("frame_channel rejects frames once all slots are in flight")
+{
+    test_utils::with_python([]()
+        {
+            frame_channel<int> channel(2, 3, 2);
+            std::vector<int> frame(6, 1);
+
+            CHECK(channel.try_push(frame));
+            CHECK(channel.try_push(frame));
+            CHECK_FALSE(channel.try_push(frame));
+            CHECK(channel.try_acquire().empty());
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("frame_channel recycles slots once the array is released")
+{
+    test_utils::with_python([]()
+        {
+            frame_channel<int> channel(1, 3, 2);
+            std::vector<int> frame(6);
+            std::iota(frame.begin(), frame.end(), 0);
+
+            CHECK_FALSE(channel.try_pop().has_value());
+            CHECK(channel.try_push(frame));
+            {
+                auto arr = channel.try_pop();
+                REQUIRE(arr.has_value());
+                CHECK(arr->shape(0) == 2);
+                CHECK(arr->shape(1) == 3);
+                CHECK(arr->at(1, 2) == 5);
+
+                // The single slot is held by python
+                CHECK_FALSE(channel.try_push(frame));
+            }
+            CHECK(channel.try_push(frame));
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("frame_channel accounts frames held by python in the memory tracking")
+{
+    test_utils::with_python([]()
+        {
+            frame_channel<int> channel(1, 3, 2);
+            std::vector<int> frame(6, 1);
+
+            set_memory_tracking(true);
+            const auto before = memory_usage();
+            CHECK(channel.try_push(frame));
+            {
+                auto arr = channel.try_pop();
+                REQUIRE(arr.has_value());
+                CHECK(memory_usage().live_bytes == before.live_bytes + frame.size() * sizeof(int));
+            }
+            CHECK(memory_usage().live_bytes == before.live_bytes);
+            set_memory_tracking(false);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("frame_channel throws on mismatched frame size")
+{
+    test_utils::with_python([]()
+        {
+            frame_channel<float> channel(2, 4, 4);
+            std::vector<float> frame(15);
+            CHECK_THROWS_AS(channel.try_push(frame), py::value_error);
+            CHECK_THROWS_AS(frame_channel<float>(0, 4, 4), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("frame_channel delivers frames from a producer thread in order")
+{
+    test_utils::with_python([]()
+        {
+            constexpr int num_frames = 64;
+            frame_channel<int> channel(4, 8, 8);
+
+            std::thread producer([&]()
+                {
+                    for (int i = 0; i < num_frames; ++i)
+                    {
+                        std::span<int> slot;
+                        while ((slot = channel.try_acquire()).empty())
+                        {
+                            std::this_thread::yield();
+                        }
+                        std::fill(slot.begin(), slot.end(), i);
+                        channel.commit();
+                    }
+                });
+
+            int received = 0;
+            {
+                py::gil_scoped_release release;
+                while (received < num_frames)
+                {
+                    py::gil_scoped_acquire acquire;
+                    if (auto arr = channel.try_pop())
+                    {
+                        CHECK(arr->at(7, 7) == received);
+                        ++received;
+                    }
+                }
+            }
+            producer.join();
+            CHECK(received == num_frames);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("frame_channel frames outlive the channel")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> frame(6);
+            std::iota(frame.begin(), frame.end(), 0);
+
+            std::optional<py::array_t<int>> first;
+            std::optional<py::array_t<int>> second;
+            {
+                frame_channel<int> channel(3, 3, 2);
+                CHECK(channel.try_push(frame));
+                CHECK(channel.try_push(frame));
+                CHECK(channel.try_push(frame));
+                first = channel.try_pop();
+                second = channel.try_pop();
+
+                // Moving the channel keeps the frames handed out so far valid
+                frame_channel<int> moved = std::move(channel);
+                CHECK(moved.capacity() == 3);
+            }
+            REQUIRE(first.has_value());
+            REQUIRE(second.has_value());
+            CHECK(first->at(1, 2) == 5);
+            first.reset();
+            CHECK(second->at(0, 1) == 1);
+            second.reset();
+        });
+}
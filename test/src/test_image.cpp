@@ -1,6 +1,10 @@
 #include "doctest.h"
 
 #include <vector>
+#include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include <pybind11/embed.h>
 #include <pybind11/numpy.h>
@@ -136,4 +140,682 @@ TEST_CASE("to_py_array from moved std::vector behaves correctly")
             CHECK(r(0, 0) == 9);
             CHECK(r(1, 1) == 6);
         });
-}
\ No newline at end of file
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("try_from_py_array returns the data for valid input")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+
+            validation_result<std::vector<int>> vec = try_from_py_array(tag::vector{}, arr, 3, 2);
+            REQUIRE(vec.has_value());
+            CHECK(*vec == buffer);
+
+            auto span = try_from_py_array(tag::view{}, arr, 3, 2);
+            REQUIRE(span.has_value());
+            CHECK(span->size() == 6);
+            CHECK(span->back() == 6);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("try_from_py_array returns an error instead of throwing")
+{
+    test_utils::with_python([]()
+        {
+            py::array_t<int> arr({ 2, 3 });
+
+            auto vec = try_from_py_array(tag::vector{}, arr, 2, 3);
+            REQUIRE_FALSE(vec.has_value());
+            CHECK(vec.error().code == validation_errc::invalid_dimension);
+            CHECK_FALSE(vec.error().message().empty());
+            CHECK_THROWS_AS(vec.value(), py::value_error);
+
+            auto span = try_from_py_array(tag::view{}, arr, 4, 4);
+            REQUIRE_FALSE(span.has_value());
+            CHECK(span.error().code == validation_errc::invalid_size);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array with debug and unchecked policies matches the checked path")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+
+            CHECK(from_py_array(tag::vector{}, arr, 3, 2, policy::debug{}) == buffer);
+            CHECK(from_py_array(tag::vector{}, arr, 3, 2, policy::unchecked{}) == buffer);
+
+            auto span = from_py_array(tag::view{}, arr, 3, 2, policy::unchecked{});
+            CHECK(span.size() == 6);
+            CHECK(span.back() == 6);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array with unchecked policy yields correct shape and values")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> vec{ 1, 2, 3, 4, 5, 6 };
+            auto copied = to_py_array(std::span<const int>(vec), 3, 2, policy::unchecked{});
+            CHECK(copied.shape(0) == 2);
+            CHECK(copied.shape(1) == 3);
+            CHECK(copied.at(1, 2) == 6);
+
+            auto moved = to_py_array(std::move(vec), 3, 2, policy::debug{});
+            CHECK(moved.shape(0) == 2);
+            CHECK(moved.at(0, 0) == 1);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array with checked policy still throws on mismatched size")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> vec{ 1, 2, 3, 4, 5 };
+            CHECK_THROWS_AS(to_py_array(vec, 3, 2, policy::checked{}), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array stacks channels into a planar 3D array")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<std::vector<int>> channels{ { 1, 2, 3, 4, 5, 6 }, { 7, 8, 9, 10, 11, 12 } };
+            auto arr = to_py_array(channels, 3, 2);
+
+            CHECK(arr.ndim() == 3);
+            CHECK(arr.shape(0) == 2);
+            CHECK(arr.shape(1) == 2);
+            CHECK(arr.shape(2) == 3);
+            CHECK(arr.at(0, 1, 2) == 6);
+            CHECK(arr.at(1, 0, 0) == 7);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array stacks channels into an interleaved 3D array")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> r{ 1, 2, 3, 4 };
+            std::vector<int> g{ 5, 6, 7, 8 };
+            std::vector<int> b{ 9, 10, 11, 12 };
+            std::vector<std::span<const int>> spans{ r, g, b };
+            auto arr = to_py_array(std::span<const std::span<const int>>(spans), 2, 2, layout::interleaved);
+
+            CHECK(arr.ndim() == 3);
+            CHECK(arr.shape(0) == 2);
+            CHECK(arr.shape(1) == 2);
+            CHECK(arr.shape(2) == 3);
+            CHECK(arr.at(0, 0, 0) == 1);
+            CHECK(arr.at(0, 0, 2) == 9);
+            CHECK(arr.at(1, 1, 1) == 8);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array stacks a channel map in ascending index order")
+{
+    test_utils::with_python([]()
+        {
+            std::unordered_map<int, std::vector<float>> channels;
+            channels[1] = { 1.0f, 1.0f };
+            channels[-1] = { -1.0f, -1.0f };
+            channels[0] = { 0.0f, 0.0f };
+            auto arr = to_py_array(channels, 2, 1);
+
+            CHECK(arr.shape(0) == 3);
+            CHECK(arr.at(0, 0, 0) == -1.0f);
+            CHECK(arr.at(1, 0, 1) == 0.0f);
+            CHECK(arr.at(2, 0, 0) == 1.0f);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array throws when a channel does not match the shape")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<std::vector<int>> channels{ { 1, 2, 3, 4 }, { 5, 6, 7 } };
+            CHECK_THROWS_AS(to_py_array(channels, 2, 2), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array from moved pitched vector exposes the padding through strides")
+{
+    test_utils::with_python([]()
+        {
+            // 3x2 image with rows padded to 4 elements
+            std::vector<int> vec{ 1, 2, 3, -1, 4, 5, 6, -1 };
+            const int* data_ptr = vec.data();
+            auto arr = to_py_array(std::move(vec), 3, 2, row_pitch::in_elements<int>(4));
+
+            CHECK(arr.shape(0) == 2);
+            CHECK(arr.shape(1) == 3);
+            CHECK(arr.strides(0) == 4 * sizeof(int));
+            CHECK(arr.strides(1) == sizeof(int));
+            CHECK(arr.data() == data_ptr);
+            CHECK(arr.at(0, 2) == 3);
+            CHECK(arr.at(1, 0) == 4);
+            CHECK(arr.at(1, 2) == 6);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array from pitched span strips the padding")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<uint8_t> vec{ 1, 2, 3, 0, 0, 0, 0, 0, 4, 5, 6 };
+            auto arr = to_py_array(std::span<const uint8_t>(vec), 3, 2, row_pitch::in_bytes(8));
+
+            CHECK(arr.shape(0) == 2);
+            CHECK(arr.shape(1) == 3);
+            CHECK(arr.strides(0) == 3);
+            CHECK(arr.at(0, 0) == 1);
+            CHECK(arr.at(1, 0) == 4);
+            CHECK(arr.at(1, 2) == 6);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array from pitched buffer throws on invalid pitch")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<float> vec(16);
+            // Not a multiple of sizeof(float)
+            CHECK_THROWS_AS(to_py_array(vec, 3, 2, row_pitch::in_bytes(13)), py::value_error);
+            // Smaller than a single row
+            CHECK_THROWS_AS(to_py_array(vec, 3, 2, row_pitch::in_elements<float>(2)), py::value_error);
+            // Buffer too small for the number of rows
+            CHECK_THROWS_AS(to_py_array(vec, 3, 4, row_pitch::in_elements<float>(8)), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array from shared vector is read-only and shares the buffer")
+{
+    test_utils::with_python([]()
+        {
+            auto vec = std::make_shared<std::vector<int>>(std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+            auto arr = to_py_array(std::shared_ptr<const std::vector<int>>(vec), 3, 2);
+
+            CHECK(arr.shape(0) == 2);
+            CHECK(arr.shape(1) == 3);
+            CHECK_FALSE(arr.writeable());
+            CHECK(arr.data() == vec->data());
+            // Python holds its own reference to the buffer
+            CHECK(vec.use_count() == 2);
+            CHECK(arr.at(1, 2) == 6);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array from shared vector throws on null or mismatched buffer")
+{
+    test_utils::with_python([]()
+        {
+            std::shared_ptr<const std::vector<int>> empty;
+            CHECK_THROWS_AS(to_py_array(empty, 3, 2), py::value_error);
+
+            auto vec = std::make_shared<std::vector<int>>(5);
+            CHECK_THROWS_AS(to_py_array(vec, 3, 2), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("ensure_writeable only copies read-only arrays")
+{
+    test_utils::with_python([]()
+        {
+            auto vec = std::make_shared<std::vector<int>>(std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+            auto shared = to_py_array(vec, 3, 2);
+            auto copied = ensure_writeable(shared);
+            CHECK(copied.writeable());
+            CHECK(copied.data() != vec->data());
+            CHECK(copied.at(1, 2) == 6);
+
+            auto owned = to_py_array(std::vector<int>{ 1, 2, 3, 4, 5, 6 }, 3, 2);
+            auto same = ensure_writeable(owned);
+            CHECK(same.data() == owned.data());
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array sparse round-trips through to_py_array")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<uint8_t> vec(128 * 96, 0);
+            vec[50 * 128 + 70] = 1;
+            auto arr = to_py_array(vec, 128, 96);
+
+            auto sparse = from_py_array(tag::sparse{}, arr, 128, 96, 32);
+            CHECK(sparse.dense_tile_count() == 1);
+
+            auto expanded = to_py_array(sparse);
+            CHECK(expanded.shape(0) == 96);
+            CHECK(expanded.shape(1) == 128);
+            CHECK(expanded.at(50, 70) == 1);
+            CHECK(expanded.at(0, 0) == 0);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array packed round-trips through to_py_array")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<uint16_t> vec{ 0, 1023, 512, 7, 100, 1000 };
+            auto arr = to_py_array(vec, 3, 2);
+
+            auto packed = from_py_array(tag::packed<10>{}, arr, 3, 2);
+            CHECK(packed.row_bytes() == 4);
+
+            auto unpacked = to_py_array(packed);
+            CHECK(unpacked.shape(0) == 2);
+            CHECK(unpacked.shape(1) == 3);
+            CHECK(unpacked.at(0, 1) == 1023);
+            CHECK(unpacked.at(1, 2) == 1000);
+
+            CHECK_THROWS_AS(from_py_array(tag::packed<4>{}, arr, 3, 2), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_mip_chain generates the full resolution array and its mip levels")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<float> vec(8 * 5);
+            for (size_t i = 0; i < vec.size(); ++i)
+            {
+                vec[i] = static_cast<float>(i);
+            }
+            auto chain = to_py_mip_chain(vec, 8, 5, 2);
+            REQUIRE(chain.size() == 3);
+
+            CHECK(chain[0].shape(0) == 5);
+            CHECK(chain[0].shape(1) == 8);
+            CHECK(chain[0].at(4, 7) == 39.0f);
+            CHECK(chain[1].shape(0) == 2);
+            CHECK(chain[1].shape(1) == 4);
+            // (0 + 1 + 8 + 9) / 4
+            CHECK(chain[1].at(0, 0) == doctest::Approx(4.5f));
+            CHECK(chain[2].shape(0) == 1);
+            CHECK(chain[2].shape(1) == 2);
+            // All levels share a single allocation
+            CHECK(chain[1].data() == chain[0].data() + 40);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_mip_chain of an empty image only returns the full resolution array")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<float> empty;
+            auto no_columns = to_py_mip_chain(empty, 0, 6, 3);
+            REQUIRE(no_columns.size() == 1);
+            CHECK(no_columns[0].shape(0) == 6);
+            CHECK(no_columns[0].shape(1) == 0);
+
+            auto no_rows = to_py_mip_chain(empty, 6, 0, 3);
+            REQUIRE(no_rows.size() == 1);
+            CHECK(no_rows[0].size() == 0);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("paste_into copies a region into a 2D array")
+{
+    test_utils::with_python([]()
+        {
+            auto canvas = to_py_array(std::vector<int>(6 * 4, 0), 6, 4);
+            std::vector<int> tile{ 1, 2, 3, 4 };
+            paste_into(canvas, tile, 3, 1, 2, 2);
+
+            CHECK(canvas.at(1, 3) == 1);
+            CHECK(canvas.at(1, 4) == 2);
+            CHECK(canvas.at(2, 3) == 3);
+            CHECK(canvas.at(2, 4) == 4);
+            CHECK(canvas.at(0, 0) == 0);
+            CHECK(canvas.at(3, 5) == 0);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("paste_into copies a region into a 3D interleaved array")
+{
+    test_utils::with_python([]()
+        {
+            py::array_t<uint8_t> canvas(std::vector<size_t>{ 4, 4, 3 });
+            std::fill(canvas.mutable_data(), canvas.mutable_data() + canvas.size(), uint8_t{ 0 });
+            std::vector<uint8_t> tile{ 1, 2, 3, 4, 5, 6 };
+            paste_into(canvas, tile, 2, 3, 2, 1);
+
+            CHECK(canvas.at(3, 2, 0) == 1);
+            CHECK(canvas.at(3, 2, 2) == 3);
+            CHECK(canvas.at(3, 3, 0) == 4);
+            CHECK(canvas.at(3, 3, 2) == 6);
+            CHECK(canvas.at(2, 2, 0) == 0);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("paste_into supports arrays with negative strides")
+{
+    test_utils::with_python([]()
+        {
+            auto canvas = to_py_array(std::vector<int>(6 * 4, 0), 6, 4);
+            auto flipped = py::module_::import("numpy").attr("flipud")(canvas).cast<py::array_t<int>>();
+            REQUIRE(flipped.strides(0) < 0);
+            std::vector<int> tile{ 1, 2, 3, 4 };
+            paste_into(flipped, tile, 4, 1, 2, 2);
+
+            // Row 1 of the flipped view is row 2 of the canvas
+            CHECK(canvas.at(2, 4) == 1);
+            CHECK(canvas.at(2, 5) == 2);
+            CHECK(canvas.at(1, 4) == 3);
+            CHECK(canvas.at(1, 5) == 4);
+            CHECK(canvas.at(3, 4) == 0);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("paste_into throws on out of bounds regions or mismatched buffers")
+{
+    test_utils::with_python([]()
+        {
+            auto canvas = to_py_array(std::vector<int>(6 * 4, 0), 6, 4);
+            std::vector<int> tile(4);
+            CHECK_THROWS_AS(paste_into(canvas, tile, 5, 0, 2, 2), py::value_error);
+            CHECK_THROWS_AS(paste_into(canvas, tile, 0, 3, 2, 2), py::value_error);
+            CHECK_THROWS_AS(paste_into(canvas, tile, 0, 0, 3, 2), py::value_error);
+
+            auto readonly = to_py_array(std::make_shared<std::vector<int>>(24), 6, 4);
+            CHECK_THROWS_AS(paste_into(readonly, tile, 0, 0, 2, 2), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array huge_vector round-trips through to_py_array")
+{
+    test_utils::with_python([]()
+        {
+            const size_t previous = huge_page_threshold();
+            set_huge_page_threshold(1024);
+
+            std::vector<float> vec(512 * 512);
+            std::iota(vec.begin(), vec.end(), 0.0f);
+            // Large enough to go through the huge page backed copy
+            auto arr = to_py_array(vec, 512, 512);
+            CHECK(arr.at(511, 511) == vec.back());
+
+            huge_vector<float> converted = from_py_array(tag::huge_vector{}, arr, 512, 512);
+            CHECK(std::equal(converted.begin(), converted.end(), vec.begin()));
+
+            auto moved = to_py_array(std::move(converted), 512, 512);
+            CHECK(moved.at(1, 0) == 512.0f);
+            set_huge_page_threshold(previous);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("generated outputs above the huge page threshold are backed by a huge_vector")
+{
+    test_utils::with_python([]()
+        {
+            const size_t previous = huge_page_threshold();
+            set_huge_page_threshold(1024);
+
+            std::vector<std::vector<float>> channels(3, std::vector<float>(256 * 128, 0.5f));
+            channels[2].back() = 2.0f;
+            auto stacked = to_py_array(channels, 256, 128);
+            CHECK_FALSE(stacked.owndata());
+            CHECK(stacked.at(2, 127, 255) == 2.0f);
+            CHECK(stacked.at(0, 0, 0) == 0.5f);
+
+            auto quantized = to_py_array<uint8_t>(channels[0], 256, 128, quantization{});
+            CHECK_FALSE(quantized.owndata());
+            CHECK(quantized.at(127, 255) == 128);
+
+            // Small outputs are still allocated by numpy
+            std::vector<std::vector<float>> small(2, std::vector<float>(4, 1.0f));
+            CHECK(to_py_array(small, 2, 2).owndata());
+            set_huge_page_threshold(previous);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array quantizes float data into uint8 and uint16")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<float> vec{ -1.0f, 0.0f, 0.5f, 1.0f, 2.0f, 0.25f };
+            auto arr = to_py_array<uint8_t>(vec, 3, 2, quantization{});
+            CHECK(arr.ndim() == 2);
+            CHECK(arr.at(0, 0) == 0);
+            CHECK(arr.at(0, 1) == 0);
+            CHECK(arr.at(0, 2) == 128);
+            CHECK(arr.at(1, 0) == 255);
+            CHECK(arr.at(1, 1) == 255);
+            CHECK(arr.at(1, 2) == 64);
+
+            auto wide = to_py_array<uint16_t>(std::span<const float>(vec), 3, 2, quantization{ .low = -1.0, .high = 2.0 });
+            CHECK(wide.at(0, 0) == 0);
+            CHECK(wide.at(1, 1) == 65535);
+
+            CHECK_THROWS_AS(to_py_array<uint8_t>(vec, 3, 2, quantization{ .low = 1.0, .high = 1.0 }), py::value_error);
+            CHECK_THROWS_AS(to_py_array<uint8_t>(vec, 4, 2, quantization{}), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array::vector writes into an existing vector reusing its storage")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+
+            std::vector<int> out;
+            from_py_array(tag::vector{}, arr, 3, 2, out);
+            CHECK(out == buffer);
+
+            // Converting again into the same vector must not reallocate
+            const int* storage = out.data();
+            out.assign(6, 0);
+            from_py_array(tag::vector{}, arr, 3, 2, out);
+            CHECK(out.data() == storage);
+            CHECK(out == buffer);
+
+            // A larger vector is shrunk to the expected size keeping its capacity
+            std::vector<int> large(100, -1);
+            from_py_array(tag::vector{}, arr, 3, 2, large);
+            CHECK(large == buffer);
+            CHECK(large.capacity() >= 100);
+
+            CHECK_THROWS_AS(from_py_array(tag::vector{}, arr, 2, 2, out), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array::vector writes into a caller provided span")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+
+            std::vector<int> storage(6);
+            from_py_array(tag::vector{}, arr, 3, 2, std::span<int>(storage));
+            CHECK(storage == buffer);
+
+            // Fortran ordered input is transposed into the span
+            py::array_t<int> transposed = arr.attr("T").cast<py::array_t<int>>();
+            std::vector<int> transposed_storage(6);
+            from_py_array(tag::vector{}, transposed, 2, 3, std::span<int>(transposed_storage));
+            CHECK(transposed_storage == std::vector<int>{ 1, 4, 2, 5, 3, 6 });
+
+            std::vector<int> too_small(5);
+            CHECK_THROWS_AS(from_py_array(tag::vector{}, arr, 3, 2, std::span<int>(too_small)), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array copying overloads never rebind the callers' array")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6, 7, 8 };
+            py::array_t<int> arr({ 2, 4 }, buffer.data());
+            // Every other column, neither C- nor Fortran-contiguous so this requires a forcecast
+            py::array_t<int> strided = arr[py::make_tuple(py::slice(0, 2, 1), py::slice(0, 4, 2))].cast<py::array_t<int>>();
+            REQUIRE(!detail::is_c_style_contiguous(strided));
+            const auto* handle = strided.ptr();
+
+            CHECK(from_py_array(tag::vector{}, strided, 2, 2) == std::vector<int>{ 1, 3, 5, 7 });
+            CHECK(from_py_array(tag::huge_vector{}, strided, 2, 2)[3] == 7);
+            CHECK(from_py_array(tag::sparse{}, strided, 2, 2).at(1, 1) == 7);
+            auto result = try_from_py_array(tag::vector{}, strided, 2, 2);
+            REQUIRE(result.has_value());
+            CHECK(*result == std::vector<int>{ 1, 3, 5, 7 });
+
+            CHECK(strided.ptr() == handle);
+            CHECK(!detail::is_c_style_contiguous(strided));
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array converts shared arrays concurrently from many threads")
+{
+    test_utils::with_python([]()
+        {
+            constexpr size_t width = 64;
+            constexpr size_t height = 48;
+            constexpr size_t num_threads = 8;
+            constexpr size_t iterations = 50;
+
+            std::vector<float> buffer(width * height);
+            std::iota(buffer.begin(), buffer.end(), 0.0f);
+            py::array_t<float> arr({ height, width }, buffer.data());
+            py::array_t<float> transposed = arr.attr("T").cast<py::array_t<float>>();
+            py::array_t<float> strided = arr[py::make_tuple(py::slice(0, height, 2), py::slice(0, width, 1))].cast<py::array_t<float>>();
+
+            std::atomic<size_t> mismatches = 0;
+            auto worker = [&]()
+                {
+                    std::vector<float> out;
+                    std::vector<float> columns;
+                    std::vector<float> rows;
+                    for (size_t i = 0; i < iterations; ++i)
+                    {
+                        // Only the conversions touch python objects, the results are verified without the GIL so
+                        // the threads actually overlap
+                        {
+                            py::gil_scoped_acquire acquire;
+                            from_py_array(tag::vector{}, arr, width, height, out);
+                            columns = from_py_array(tag::vector{}, transposed, height, width);
+                            rows = from_py_array(tag::vector{}, strided, width, height / 2);
+                        }
+
+                        mismatches += out != buffer;
+                        for (size_t y = 0; y < height; ++y)
+                        {
+                            for (size_t x = 0; x < width; ++x)
+                            {
+                                mismatches += columns[x * height + y] != buffer[y * width + x];
+                                mismatches += y % 2 == 0 && rows[y / 2 * width + x] != buffer[y * width + x];
+                            }
+                        }
+                    }
+                };
+
+            {
+                py::gil_scoped_release release;
+                std::vector<std::thread> threads;
+                for (size_t i = 0; i < num_threads; ++i)
+                {
+                    threads.emplace_back(worker);
+                }
+                for (auto& thread : threads)
+                {
+                    thread.join();
+                }
+            }
+            CHECK(mismatches.load() == 0);
+            CHECK(!detail::is_c_style_contiguous(strided));
+        });
+}
@@ -0,0 +1,106 @@
+#include "doctest.h"
+
+#include <vector>
+#include <optional>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+
+#include "py_img_util/image.h"
+
+#include "test_utils.h"
+
+namespace py = pybind11;
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("lazy_array validates the shape eagerly")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+
+            CHECK_THROWS_AS(from_py_array(tag::lazy{}, arr, 2, 3), py::value_error);
+            CHECK_NOTHROW(from_py_array(tag::lazy{}, arr, 3, 2));
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("lazy_array exposes contiguous arrays without copying")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+
+            auto lazy = from_py_array(tag::lazy{}, arr, 3, 2);
+            CHECK(lazy.has_value());
+            CHECK_FALSE(lazy.is_materialized());
+
+            auto data = lazy.data();
+            CHECK(lazy.is_materialized());
+            CHECK(lazy.is_zero_copy());
+            CHECK(data.data() == arr.data());
+            CHECK(std::vector<int>(data.begin(), data.end()) == buffer);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("lazy_array converts non-contiguous arrays on first access and caches the result")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+            py::array_t<int> transposed = arr.attr("T").cast<py::array_t<int>>();
+
+            auto lazy = from_py_array(tag::lazy{}, transposed, 2, 3);
+            auto data = lazy.data();
+            CHECK_FALSE(lazy.is_zero_copy());
+            CHECK(std::vector<int>(data.begin(), data.end()) == std::vector<int>{ 1, 4, 2, 5, 3, 6 });
+            CHECK(lazy.data().data() == data.data());
+
+            CHECK(std::move(lazy).release() == std::vector<int>{ 1, 4, 2, 5, 3, 6 });
+            CHECK_FALSE(lazy.has_value());
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("copies of a materialized lazy_array outlive the original")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<int> buffer{ 1, 2, 3, 4, 5, 6 };
+            py::array_t<int> arr({ 2, 3 }, buffer.data());
+            py::array_t<int> transposed = arr.attr("T").cast<py::array_t<int>>();
+
+            std::optional<lazy_array<int>> original = from_py_array(tag::lazy{}, transposed, 2, 3);
+            REQUIRE(original->data().size() == 6);
+            lazy_array<int> copy = *original;
+            original.reset();
+
+            auto data = copy.data();
+            CHECK(copy.is_materialized());
+            CHECK(std::vector<int>(data.begin(), data.end()) == std::vector<int>{ 1, 4, 2, 5, 3, 6 });
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("default constructed lazy_array represents an absent input")
+{
+    lazy_array<float> lazy;
+    CHECK_FALSE(lazy);
+    CHECK(lazy.data().empty());
+    CHECK(lazy.to_vector().empty());
+}
@@ -0,0 +1,127 @@
+#include "doctest.h"
+
+#include <vector>
+#include <cstdint>
+
+#include "test_utils.h"
+#include "py_img_util/image.h"
+#include "py_img_util/memory.h"
+#include "py_img_util/memory_bindings.h"
+
+namespace py = pybind11;
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("memory_token does not account anything while tracking is disabled")
+{
+    set_memory_tracking(false);
+    const auto before = memory_usage();
+    {
+        detail::memory_token token(1024);
+        CHECK(memory_usage().live_bytes == before.live_bytes);
+        CHECK(memory_usage().total_allocations == before.total_allocations);
+    }
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("memory_token accounts live and peak bytes")
+{
+    set_memory_tracking(true);
+    const auto before = memory_usage();
+    {
+        detail::memory_token a(1000);
+        {
+            detail::memory_token b(500);
+            CHECK(memory_usage().live_bytes == before.live_bytes + 1500);
+            CHECK(memory_usage().live_allocations == before.live_allocations + 2);
+        }
+        CHECK(memory_usage().live_bytes == before.live_bytes + 1000);
+        CHECK(memory_usage().peak_bytes >= before.live_bytes + 1500);
+
+        // Moving the token must not release the allocation
+        detail::memory_token moved = std::move(a);
+        CHECK(memory_usage().live_bytes == before.live_bytes + 1000);
+    }
+    CHECK(memory_usage().live_bytes == before.live_bytes);
+    CHECK(memory_usage().total_allocations == before.total_allocations + 2);
+    set_memory_tracking(false);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("scoped_memory_label tags allocations made in scope")
+{
+    set_memory_tracking(true);
+    {
+        scoped_memory_label outer("test_outer");
+        detail::memory_token a(100);
+        {
+            scoped_memory_label inner("test_inner");
+            detail::memory_token b(200);
+            CHECK(memory_usage("test_inner").live_bytes == 200);
+        }
+        CHECK(memory_usage("test_outer").live_bytes == 100);
+        CHECK(memory_usage("test_inner").live_bytes == 200);
+    }
+    CHECK(memory_usage("test_outer").live_bytes == 0);
+    CHECK(memory_usage("test_inner").live_bytes == 0);
+    CHECK(memory_usage("test_inner").peak_bytes == 200);
+    CHECK(memory_usage("test_unknown").total_allocations == 0);
+    set_memory_tracking(false);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array from moved vector is accounted until the array dies")
+{
+    test_utils::with_python([]()
+        {
+            set_memory_tracking(true);
+            const auto before = memory_usage();
+            {
+                std::vector<uint16_t> vec(64 * 32);
+                const size_t bytes = vec.capacity() * sizeof(uint16_t);
+                scoped_memory_label label("test_to_py_array");
+                auto arr = to_py_array(std::move(vec), 64, 32);
+                CHECK(arr.shape(0) == 32);
+                CHECK(memory_usage().live_bytes == before.live_bytes + bytes);
+                CHECK(memory_usage("test_to_py_array").live_allocations == 1);
+            }
+            CHECK(memory_usage().live_bytes == before.live_bytes);
+            CHECK(memory_usage("test_to_py_array").live_allocations == 0);
+            set_memory_tracking(false);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("bind_memory_tracking exposes the accounting to python")
+{
+    test_utils::with_python([]()
+        {
+            auto m = py::module_::import("types").attr("ModuleType")("memory_test").cast<py::module_>();
+            bind_memory_tracking(m);
+
+            m.attr("set_memory_tracking")(true);
+            CHECK(memory_tracking_enabled());
+            auto usage = m.attr("memory_usage")().cast<py::dict>();
+            CHECK(usage.contains("live_bytes"));
+            CHECK(m.attr("memory_usage")("unknown_label").cast<py::dict>()["live_allocations"].cast<size_t>() == 0);
+            {
+                scoped_memory_label label("test_bindings");
+                detail::memory_token token(64);
+                auto by_label = m.attr("memory_usage_by_label")().cast<py::dict>();
+                CHECK(by_label.contains("test_bindings"));
+                CHECK_FALSE(by_label.contains("unknown_label"));
+            }
+            m.attr("set_memory_tracking")(false);
+            CHECK_FALSE(memory_tracking_enabled());
+        });
+}
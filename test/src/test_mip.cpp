@@ -0,0 +1,108 @@
+#include "doctest.h"
+
+#include <vector>
+#include <cstdint>
+
+#include "py_img_util/mip.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("mip_chain_layout halves each level and packs them back to back")
+{
+    auto chain = detail::mip_chain_layout(10, 5, 8);
+    REQUIRE(chain.size() == 4);
+    CHECK(chain[1].width == 5);
+    CHECK(chain[1].height == 2);
+    CHECK(chain[1].offset == 50);
+    CHECK(chain[2].width == 2);
+    CHECK(chain[2].height == 1);
+    CHECK(chain[2].offset == 60);
+    CHECK(chain[3].width == 1);
+    CHECK(chain[3].height == 1);
+    CHECK(chain[3].offset == 62);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("mip_chain_layout stops at 1x1")
+{
+    CHECK(detail::mip_chain_layout(4, 4, 10).size() == 3);
+    CHECK(detail::mip_chain_layout(1, 1, 10).size() == 1);
+    CHECK(detail::mip_chain_layout(16, 16, 0).size() == 1);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("mip_chain_layout has no mip levels for empty images")
+{
+    CHECK(detail::mip_chain_layout(0, 8, 4).size() == 1);
+    CHECK(detail::mip_chain_layout(8, 0, 4).size() == 1);
+    CHECK(detail::mip_chain_layout(0, 0, 4).size() == 1);
+    CHECK(detail::mip_chain_layout(0, 8, 4)[0].height == 8);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("downsample_row box filter averages 2x2 blocks with rounding")
+{
+    const uint8_t row0[5] = { 0, 1, 10, 20, 255 };
+    const uint8_t row1[5] = { 1, 1, 30, 40, 255 };
+    uint8_t out[2] = {};
+    detail::downsample_row(row0, row1, out, 5, 2, mip_filter::box);
+    CHECK(out[0] == 1);
+    CHECK(out[1] == 25);
+
+    const float frow0[2] = { 1.0f, 2.0f };
+    const float frow1[2] = { 3.0f, 4.0f };
+    float fout[1] = {};
+    detail::downsample_row(frow0, frow1, fout, 2, 1, mip_filter::box);
+    CHECK(fout[0] == doctest::Approx(2.5f));
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("downsample_row handles single column sources and nearest filtering")
+{
+    const uint16_t row0[1] = { 100 };
+    const uint16_t row1[1] = { 201 };
+    uint16_t out[1] = {};
+    detail::downsample_row(row0, row1, out, 1, 1, mip_filter::box);
+    CHECK(out[0] == 151);
+
+    const int16_t nrow0[4] = { -1, 2, 3, 4 };
+    const int16_t nrow1[4] = { 5, 6, 7, 8 };
+    int16_t nout[2] = {};
+    detail::downsample_row(nrow0, nrow1, nout, 4, 2, mip_filter::nearest);
+    CHECK(nout[0] == -1);
+    CHECK(nout[1] == 3);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("downsample_row box filter rounds negative averages half up")
+{
+    const int16_t row0[6] = { -1, -1, -3, -4, -2, 2 };
+    const int16_t row1[6] = { -1, -1, -5, -6, -1, 0 };
+    int16_t out[3] = {};
+    detail::downsample_row(row0, row1, out, 6, 3, mip_filter::box);
+    CHECK(out[0] == -1);
+    // -18 / 4 = -4.5 rounds up to -4
+    CHECK(out[1] == -4);
+    // -1 / 4 = -0.25 rounds to 0
+    CHECK(out[2] == 0);
+
+    const int16_t col0[1] = { -1 };
+    const int16_t col1[1] = { -2 };
+    int16_t col_out[1] = {};
+    detail::downsample_row(col0, col1, col_out, 1, 1, mip_filter::box);
+    // -3 / 2 = -1.5 rounds up to -1
+    CHECK(col_out[0] == -1);
+}
@@ -0,0 +1,88 @@
+#include "doctest.h"
+
+#include <vector>
+#include <cstdint>
+
+#include "py_img_util/packed.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("pack_row with 1 bit matches np.packbits")
+{
+    const bool mask[9] = { true, false, true, false, false, false, false, true, true };
+    packed_image<1> image(9, 1);
+    CHECK(image.row_bytes() == 2);
+    CHECK(detail::pack_row<1>(mask, image.row(0).data(), 9) == 0);
+    CHECK(image.data()[0] == 0xA1);
+    CHECK(image.data()[1] == 0x80);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("pack_row with 12 bits packs two samples into three bytes")
+{
+    const uint16_t samples[3] = { 0xABC, 0x123, 0xFFF };
+    packed_image<12> image(3, 1);
+    CHECK(image.row_bytes() == 5);
+    detail::pack_row<12>(samples, image.row(0).data(), 3);
+    CHECK(image.data()[0] == 0xAB);
+    CHECK(image.data()[1] == 0xC1);
+    CHECK(image.data()[2] == 0x23);
+    CHECK(image.data()[3] == 0xFF);
+    CHECK(image.data()[4] == 0xF0);
+    CHECK(image.at(1, 0) == 0x123);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("pack_row and unpack_row round-trip all supported bit depths")
+{
+    auto round_trip = []<size_t Bits>()
+    {
+        for (size_t width = 1; width < 20; ++width)
+        {
+            std::vector<uint16_t> samples(width);
+            for (size_t x = 0; x < width; ++x)
+            {
+                samples[x] = static_cast<uint16_t>((x * 37 + 5) & packed_image<Bits>::max_value);
+            }
+            packed_image<Bits> image(width, 1);
+            CHECK(detail::pack_row<Bits>(samples.data(), image.row(0).data(), width) == 0);
+
+            std::vector<uint16_t> unpacked(width);
+            detail::unpack_row<Bits>(image.row(0).data(), unpacked.data(), width);
+            CHECK(unpacked == samples);
+        }
+    };
+    round_trip.template operator()<1>();
+    round_trip.template operator()<2>();
+    round_trip.template operator()<4>();
+    round_trip.template operator()<10>();
+    round_trip.template operator()<12>();
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("pack_row reports overflowing and negative samples")
+{
+    packed_image<4> image(2, 1);
+    const uint8_t too_large[2] = { 3, 16 };
+    CHECK(detail::pack_row<4>(too_large, image.row(0).data(), 2) != 0);
+    const int8_t negative[2] = { 3, -1 };
+    CHECK(detail::pack_row<4>(negative, image.row(0).data(), 2) != 0);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("packed_image throws on mismatched data size")
+{
+    CHECK_THROWS_AS(packed_image<10>(std::vector<uint8_t>(4), 4, 1), pybind11::value_error);
+    CHECK_NOTHROW(packed_image<10>(std::vector<uint8_t>(5), 4, 1));
+}
@@ -0,0 +1,56 @@
+#include "doctest.h"
+
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+#include "py_img_util/parallel.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL::detail;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("parallel_for visits every item exactly once")
+{
+    std::vector<int> visited(10000, 0);
+    parallel_for(visited.size(), 16, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                visited[i] += 1;
+            }
+        });
+
+    for (const auto count : visited)
+    {
+        CHECK(count == 1);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("parallel_for runs inline for a single chunk")
+{
+    std::atomic<size_t> calls = 0;
+    parallel_for(10, 100, [&](size_t begin, size_t end)
+        {
+            CHECK(begin == 0);
+            CHECK(end == 10);
+            ++calls;
+        });
+    CHECK(calls == 1);
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("parallel_for rethrows exceptions on the calling thread")
+{
+    CHECK_THROWS_AS(parallel_for(1000, 1, [](size_t begin, size_t)
+        {
+            if (begin == 0)
+            {
+                throw std::runtime_error("chunk failed");
+            }
+        }), std::runtime_error);
+}
@@ -0,0 +1,94 @@
+#include "doctest.h"
+
+#include <vector>
+#include <span>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+
+#include "py_img_util/planar_view.h"
+#include "py_img_util/image.h"
+
+#include "test_utils.h"
+
+namespace py = pybind11;
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("planar_view hands out a span per channel")
+{
+    std::vector<int> buffer{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    planar_view<int> view(buffer, 3, 2, 2);
+
+    CHECK(view.size() == 3);
+    CHECK(view[0].size() == 4);
+    CHECK(view[1].front() == 5);
+    CHECK(view[2].back() == 12);
+
+    size_t count = 0;
+    for (auto channel : view)
+    {
+        CHECK(channel.data() == buffer.data() + count * 4);
+        ++count;
+    }
+    CHECK(count == 3);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array::planar_view views a 3D array without copying")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<float> buffer(2 * 3 * 4);
+            for (size_t i = 0; i < buffer.size(); ++i)
+            {
+                buffer[i] = static_cast<float>(i);
+            }
+            py::array_t<float> arr({ 2, 3, 4 }, buffer.data());
+
+            auto view = from_py_array(tag::planar_view{}, arr, 2, 4, 3);
+            CHECK(view.size() == 2);
+            CHECK(view.width() == 4);
+            CHECK(view.height() == 3);
+            CHECK(view[1].front() == 12.0f);
+            // The spans point straight into the numpy buffer
+            CHECK(view[0].data() == arr.data());
+            CHECK(view[1].data() == arr.data() + 12);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array::planar_view deduces the shape, no expected dims")
+{
+    test_utils::with_python([]()
+        {
+            py::array_t<uint8_t> arr({ 4, 5, 6 });
+            auto view = from_py_array(tag::planar_view{}, arr);
+            CHECK(view.size() == 4);
+            CHECK(view.height() == 5);
+            CHECK(view.width() == 6);
+            CHECK(view[3].size() == 30);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array::planar_view throws on mismatched shape")
+{
+    test_utils::with_python([]()
+        {
+            py::array_t<float> arr({ 2, 3, 4 });
+            // Wrong number of channels
+            CHECK_THROWS_AS(from_py_array(tag::planar_view{}, arr, 3, 4, 2), py::value_error);
+            // 2D input is not accepted
+            py::array_t<float> arr_2d({ 3, 4 });
+            CHECK_THROWS_AS(from_py_array(tag::planar_view{}, arr_2d, 1, 4, 3), py::value_error);
+        });
+}
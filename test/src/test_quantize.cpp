@@ -0,0 +1,63 @@
+#include "doctest.h"
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+#include "py_img_util/quantize.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("quantize_row scales, clamps and rounds")
+{
+    const std::vector<float> src = { 0.0f, 0.5f, 1.0f, 1.5f, -3.0f, std::numeric_limits<float>::quiet_NaN(), 0.2f };
+    std::vector<uint8_t> dst(src.size());
+    const auto pattern = detail::quantize_dither_pattern<float>(0, dither_mode::none);
+    detail::quantize_row(src.data(), dst.data(), src.size(), 255.0f, 0.0f, pattern);
+    CHECK(dst == std::vector<uint8_t>{ 0, 128, 255, 255, 0, 0, 51 });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("quantize_row handles rows longer than a block")
+{
+    std::vector<double> src(37);
+    for (size_t x = 0; x < src.size(); ++x)
+    {
+        src[x] = static_cast<double>(x) * 1000.0;
+    }
+    std::vector<uint16_t> dst(src.size());
+    const auto pattern = detail::quantize_dither_pattern<double>(0, dither_mode::none);
+    detail::quantize_row(src.data(), dst.data(), src.size(), 1.0, 0.0, pattern);
+    for (size_t x = 0; x < src.size(); ++x)
+    {
+        CHECK(dst[x] == static_cast<uint16_t>(x * 1000));
+    }
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("ordered dithering preserves the mean of a flat region")
+{
+    // A value a quarter of the way between two output steps should be rounded up for a quarter of the pixels
+    const float value = 10.25f;
+    std::vector<float> src(64, value);
+    std::vector<uint8_t> dst(src.size());
+    size_t total = 0;
+    for (size_t y = 0; y < 4; ++y)
+    {
+        const auto pattern = detail::quantize_dither_pattern<float>(y, dither_mode::ordered);
+        detail::quantize_row(src.data(), dst.data(), src.size(), 1.0f, 0.0f, pattern);
+        for (const auto v : dst)
+        {
+            CHECK((v == 10 || v == 11));
+            total += v;
+        }
+    }
+    CHECK(total == 10 * 256 + 64);
+}
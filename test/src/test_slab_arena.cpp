@@ -0,0 +1,79 @@
+#include "doctest.h"
+
+#include <vector>
+#include <numeric>
+#include <cstdint>
+
+#include "test_utils.h"
+#include "py_img_util/slab_arena.h"
+
+namespace py = pybind11;
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("slab_arena aligns entries of mixed types")
+{
+    test_utils::with_python([]()
+        {
+            slab_arena arena;
+            std::vector<uint8_t> small{ 1, 2, 3 };
+            std::vector<double> values{ 1.0, 2.0 };
+
+            CHECK(arena.add(std::span<const uint8_t>(small), 3, 1) == 0);
+            CHECK(arena.add(std::span<const double>(values), std::vector<size_t>{ 2 }) == 1);
+            CHECK(arena.size() == 2);
+            CHECK(arena.bytes() == slab_arena::alignment + 2 * sizeof(double));
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("slab_arena builds views sharing a single allocation")
+{
+    test_utils::with_python([]()
+        {
+            slab_arena arena;
+            arena.reserve<uint16_t>(8);
+            std::vector<uint16_t> a{ 1, 2, 3, 4 };
+            std::vector<uint16_t> b{ 5, 6, 7, 8 };
+            arena.add(std::span<const uint16_t>(a), 2, 2);
+            arena.add(std::span<const uint16_t>(b), 4, 1);
+            std::vector<uint16_t> c(12);
+            std::iota(c.begin(), c.end(), uint16_t{ 0 });
+            arena.add(std::span<const uint16_t>(c), std::vector<size_t>{ 2, 3, 2 });
+
+            auto arrays = arena.build();
+            REQUIRE(arrays.size() == 3);
+            CHECK(arena.size() == 0);
+
+            auto first = arrays[0].cast<py::array_t<uint16_t>>();
+            auto second = arrays[1].cast<py::array_t<uint16_t>>();
+            CHECK(first.shape(0) == 2);
+            CHECK(first.at(1, 1) == 4);
+            CHECK(second.shape(1) == 4);
+            CHECK(second.at(0, 3) == 8);
+            auto third = arrays[2].cast<py::array_t<uint16_t>>();
+            CHECK(third.ndim() == 3);
+            CHECK(third.at(1, 2, 1) == 11);
+            CHECK(arrays[0].base().ptr() == arrays[1].base().ptr());
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("slab_arena throws on mismatched shape")
+{
+    test_utils::with_python([]()
+        {
+            slab_arena arena;
+            std::vector<float> data(5);
+            CHECK_THROWS_AS(arena.add(std::span<const float>(data), 3, 2), py::value_error);
+            CHECK_THROWS_AS(arena.add(std::span<const float>(data), std::vector<size_t>{}), py::value_error);
+            CHECK_THROWS_AS(arena.add(std::span<const float>(data), std::vector<size_t>{ 5, 1, 1, 1, 1 }), py::value_error);
+            CHECK(arena.size() == 0);
+        });
+}
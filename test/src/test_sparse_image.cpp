@@ -0,0 +1,86 @@
+#include "doctest.h"
+
+#include <vector>
+#include <limits>
+#include <numeric>
+
+#include "py_img_util/sparse_image.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("sparse_image stores constant images without dense data")
+{
+    std::vector<uint8_t> data(100 * 70, 255);
+    auto image = sparse_image<uint8_t>::from_dense(data, 100, 70, 32);
+
+    CHECK(image.tiles_x() == 4);
+    CHECK(image.tiles_y() == 3);
+    CHECK(image.dense_tile_count() == 0);
+    CHECK(image.fill_value(3, 2) == 255);
+    CHECK(image.to_dense() == data);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("sparse_image only stores the tiles with differing pixels")
+{
+    constexpr size_t width = 100;
+    constexpr size_t height = 70;
+    std::vector<uint16_t> data(width * height, 0);
+    // A single pixel in the cropped bottom right tile and a gradient in the first tile
+    data[69 * width + 99] = 7;
+    for (size_t y = 0; y < 16; ++y)
+    {
+        for (size_t x = 0; x < 16; ++x)
+        {
+            data[y * width + x] = static_cast<uint16_t>(x + y);
+        }
+    }
+
+    auto image = sparse_image<uint16_t>::from_dense(data, width, height, 16);
+    CHECK(image.dense_tile_count() == 2);
+    CHECK_FALSE(image.is_uniform(0, 0));
+    CHECK_FALSE(image.is_uniform(6, 4));
+    CHECK(image.is_uniform(1, 0));
+    CHECK(image.tile_data(6, 4).size() == 4 * 6);
+    CHECK(image.at(99, 69) == 7);
+    CHECK(image.at(15, 15) == 30);
+    CHECK(image.memory_bytes() < data.size() * sizeof(uint16_t));
+    CHECK(image.to_dense() == data);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("sparse_image treats identical NaNs as uniform")
+{
+    std::vector<float> data(64 * 64, std::numeric_limits<float>::quiet_NaN());
+    auto image = sparse_image<float>::from_dense(data, 64, 64, 64);
+    CHECK(image.dense_tile_count() == 0);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("sparse_image round-trips large dense images")
+{
+    std::vector<int32_t> data(1024 * 1024);
+    std::iota(data.begin(), data.end(), 0);
+    auto image = sparse_image<int32_t>::from_dense(data, 1024, 1024);
+    CHECK(image.dense_tile_count() == image.tiles_x() * image.tiles_y());
+    CHECK(image.to_dense() == data);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("sparse_image throws on invalid input")
+{
+    std::vector<uint8_t> data(10);
+    CHECK_THROWS_AS(sparse_image<uint8_t>::from_dense(data, 5, 3), pybind11::value_error);
+    CHECK_THROWS_AS(sparse_image<uint8_t>::from_dense(data, 5, 2, 0), pybind11::value_error);
+}
@@ -0,0 +1,69 @@
+#include "doctest.h"
+
+#include <array>
+#include <string>
+#include <thread>
+
+#include "py_img_util/trace.h"
+
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("dtype_name matches the numpy names")
+{
+    CHECK(std::string(trace::dtype_name<uint8_t>()) == "uint8");
+    CHECK(std::string(trace::dtype_name<int16_t>()) == "int16");
+    CHECK(std::string(trace::dtype_name<float>()) == "float32");
+    CHECK(std::string(trace::dtype_name<double>()) == "float64");
+    CHECK(std::string(trace::dtype_name<bool>()) == "bool");
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("scoped_span records an event with shape and bytes")
+{
+    trace::clear();
+    {
+        const std::array<size_t, 2> shape = { 32, 64 };
+        trace::scoped_span span("test_span", trace::dtype_name<float>(), shape, 32 * 64 * sizeof(float));
+    }
+    const auto json = trace::to_chrome_json();
+    CHECK(json.find("\"name\":\"test_span\"") != std::string::npos);
+    CHECK(json.find("\"dtype\":\"float32\"") != std::string::npos);
+    CHECK(json.find("\"shape\":[32,64]") != std::string::npos);
+    CHECK(json.find("\"bytes\":8192") != std::string::npos);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("trace collects events from other threads and clears them")
+{
+    trace::clear();
+    std::thread worker([]()
+        {
+            const std::array<size_t, 1> shape = { 4 };
+            trace::scoped_span span("test_worker_span", trace::dtype_name<uint8_t>(), shape, 4);
+        });
+    worker.join();
+    CHECK(trace::to_chrome_json().find("test_worker_span") != std::string::npos);
+
+    trace::clear();
+    CHECK(trace::to_chrome_json() == "{\"traceEvents\":[]}");
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("PY_IMG_UTIL_TRACE_SCOPE only evaluates its arguments when tracing is enabled")
+{
+    size_t calls = 0;
+    [[maybe_unused]] auto name = [&]() { ++calls; return "test_macro_span"; };
+    {
+        PY_IMG_UTIL_TRACE_SCOPE(name(), trace::dtype_name<int>(), std::span<const size_t>{}, 0);
+    }
+    CHECK(calls == (trace::enabled ? 1 : 0));
+}
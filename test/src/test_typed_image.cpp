@@ -0,0 +1,118 @@
+#include "doctest.h"
+
+#include <vector>
+#include <array>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+
+#include "py_img_util/typed_image.h"
+#include "py_img_util/image.h"
+
+#include "test_utils.h"
+
+namespace py = pybind11;
+using namespace NAMESPACE_PY_IMAGE_UTIL;
+
+
+// Shapes and strides are fully resolvable at compile time
+static_assert(typed_image<float, layout::planar, 1>::ndim == 2);
+static_assert(typed_image<float, layout::planar, 3>::shape_for(4, 2) == std::array<size_t, 3>{ 3, 2, 4 });
+static_assert(typed_image<float, layout::interleaved, 3>::shape_for(4, 2) == std::array<size_t, 3>{ 2, 4, 3 });
+static_assert(typed_image<uint16_t, layout::planar, 3>::strides_for(4, 2) == std::array<size_t, 3>{ 16, 8, 2 });
+static_assert(typed_image<uint16_t, layout::interleaved, 3>::strides_for(4, 2) == std::array<size_t, 3>{ 24, 6, 2 });
+static_assert(typed_image<uint8_t, layout::interleaved, 1>::strides_for(4, 2) == std::array<size_t, 2>{ 4, 1 });
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("typed_image indexes planar and interleaved data correctly")
+{
+    typed_image<int, layout::planar, 2> planar(std::vector<int>{ 1, 2, 3, 4, 5, 6, 7, 8 }, 2, 2);
+    CHECK(planar(0, 0, 0) == 1);
+    CHECK(planar(1, 0, 0) == 5);
+    CHECK(planar(1, 1, 1) == 8);
+    CHECK(planar.channel(1).front() == 5);
+
+    typed_image<int, layout::interleaved, 2> interleaved(std::vector<int>{ 1, 5, 2, 6, 3, 7, 4, 8 }, 2, 2);
+    CHECK(interleaved(0, 0, 0) == 1);
+    CHECK(interleaved(1, 0, 0) == 5);
+    CHECK(interleaved(1, 1, 1) == 8);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("typed_image throws on mismatched data size")
+{
+    CHECK_THROWS_AS((typed_image<float, layout::planar, 3>(std::vector<float>(10), 2, 2)), py::value_error);
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("typed_image::to_layout round trips between planar and interleaved")
+{
+    typed_image<int, layout::planar, 3> planar(std::vector<int>{ 1, 2, 3, 4, 5, 6 }, 2, 1);
+    auto interleaved = planar.to_layout<layout::interleaved>();
+    CHECK(std::vector<int>(interleaved.data().begin(), interleaved.data().end()) == std::vector<int>{ 1, 3, 5, 2, 4, 6 });
+
+    auto back = interleaved.to_layout<layout::planar>();
+    CHECK(std::vector<int>(back.data().begin(), back.data().end()) == std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array::typed converts a planar 3D array")
+{
+    test_utils::with_python([]()
+        {
+            std::vector<float> buffer{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+            py::array_t<float> arr({ 3, 2, 2 }, buffer.data());
+
+            auto image = from_py_array(tag::typed<layout::planar, 3>{}, arr, 2, 2);
+            CHECK(image.width() == 2);
+            CHECK(image.height() == 2);
+            CHECK(image(2, 1, 1) == 12);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("from_py_array::typed throws on mismatched layout")
+{
+    test_utils::with_python([]()
+        {
+            py::array_t<float> arr({ 3, 2, 2 });
+            // An interleaved image expects [height, width, channels]
+            CHECK_THROWS_AS(from_py_array(tag::typed<layout::interleaved, 3>{}, arr, 2, 2), py::value_error);
+            // Rank mismatch
+            CHECK_THROWS_AS(from_py_array(tag::typed<layout::planar, 1>{}, arr, 2, 2), py::value_error);
+        });
+}
+
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("to_py_array from typed_image yields correct shape and values")
+{
+    test_utils::with_python([]()
+        {
+            typed_image<uint8_t, layout::interleaved, 4> image(3, 2);
+            image(3, 1, 2) = 255;
+
+            auto copied = to_py_array(image);
+            CHECK(copied.ndim() == 3);
+            CHECK(copied.shape(0) == 2);
+            CHECK(copied.shape(1) == 3);
+            CHECK(copied.shape(2) == 4);
+            CHECK(copied.at(1, 2, 3) == 255);
+
+            auto moved = to_py_array(std::move(image));
+            CHECK(moved.ndim() == 3);
+            CHECK(moved.at(1, 2, 3) == 255);
+            CHECK(image.data().empty());
+        });
+}
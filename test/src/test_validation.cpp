@@ -251,4 +251,77 @@ TEST_CASE("check_cpp_vec_matches_shape throws for zero-dimension shape vector")
     std::vector<int> data; // size 0
     std::vector<size_t> shape = {};
     CHECK_THROWS_AS(check_cpp_vec_matches_shape(data, shape), py::value_error);
-}
\ No newline at end of file
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("try_check_shape returns no error for a matching shape")
+{
+    std::vector<size_t> shape = { 3, 5, 7 };
+    auto error = try_check_shape(shape, 7, 5, 3);
+    CHECK_FALSE(error);
+    CHECK(error.code == validation_errc::none);
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("try_check_shape reports the offending dimension without throwing")
+{
+    std::vector<size_t> shape = { 3, 4, 7 };
+    auto error = try_check_shape(shape, 7, 5, 3);
+    REQUIRE(error);
+    CHECK(error.code == validation_errc::invalid_dimension);
+    CHECK(error.dimension == 1);
+    CHECK(error.expected == 5);
+    CHECK(error.actual == 4);
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("try_check_shape reports unsupported dimension counts")
+{
+    std::vector<size_t> shape = { 1, 2, 3, 4 };
+    auto error = try_check_shape(shape, 4, 1, 1);
+    CHECK(error.code == validation_errc::unsupported_ndim);
+    CHECK(error.actual == 4);
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("validation_error message matches the throwing validation")
+{
+    std::vector<size_t> shape = { 3, 6 };
+    auto error = try_check_shape_2d(shape, 7, 3);
+    REQUIRE(error);
+    try
+    {
+        check_shape_2d(shape, 7, 3);
+        FAIL_CHECK("check_shape_2d did not throw");
+    }
+    catch (const py::value_error& e)
+    {
+        CHECK(error.message() == std::string(e.what()));
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// -----------------------------------------------------------------------------------
+TEST_CASE("try_check_py_array_dims reports ndim and size mismatches")
+{
+    test_utils::with_python([]()
+        {
+            constexpr std::array<size_t, 2> allowed_dims = { 1, 2 };
+            py::array_t<float> arr({ 3, 2, 2 });
+            auto ndim_error = try_check_py_array_dims(arr, allowed_dims, 12);
+            CHECK(ndim_error.code == validation_errc::invalid_ndim);
+            CHECK(ndim_error.actual == 3);
+
+            py::array_t<float> arr_2d({ 3, 2 });
+            auto size_error = try_check_py_array_dims(arr_2d, allowed_dims, 8);
+            CHECK(size_error.code == validation_errc::invalid_size);
+            CHECK(size_error.expected == 8);
+            CHECK(size_error.actual == 6);
+
+            CHECK_FALSE(try_check_py_array_dims(arr_2d, allowed_dims, 6));
+        });
+}